@@ -0,0 +1,154 @@
+#include "Bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+void BenchSuite::Run(const BenchOptions& options)
+{
+	results_.clear();
+
+	printf("%-36s %14s %14s\n", "benchmark", "ns/op", "iterations");
+
+	for (BenchCase& bench_case : cases_)
+	{
+		if (!options.filter.empty() && bench_case.name.find(options.filter) == std::string::npos)
+		{
+			continue;
+		}
+
+		// Calibrate: double the iteration count until one repetition fills the time budget.
+		long long iterations = 1;
+		double seconds = 0.0;
+
+		while (true)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			bench_case.run(iterations);
+			seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			if (seconds >= options.min_seconds || iterations >= (1LL << 40))
+			{
+				break;
+			}
+
+			iterations *= seconds > 0.0 ? std::clamp(static_cast<long long>(options.min_seconds / seconds * 1.2), 2LL, 100LL) : 100LL;
+		}
+
+		double best = seconds;
+
+		for (int i = 1; i < options.repetitions; ++i)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			bench_case.run(iterations);
+			best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		}
+
+		const BenchResult result = { bench_case.name, best * 1e9 / static_cast<double>(iterations), iterations };
+		results_.push_back(result);
+
+		printf("%-36s %14.2f %14lld\n", result.name.c_str(), result.ns_per_op, result.iterations);
+	}
+}
+
+bool BenchSuite::WriteJson(const std::string& path) const
+{
+	FILE* file = std::fopen(path.c_str(), "w");
+
+	if (file == nullptr)
+	{
+		printf("Unable to write %s!\n", path.c_str());
+		return false;
+	}
+
+	// One result per line, so the file diffs cleanly and ReadJson can stay line-based.
+	std::fputs("{\"benchmarks\": [\n", file);
+
+	for (std::size_t i = 0; i < results_.size(); ++i)
+	{
+		std::fprintf(file, "  {\"name\": \"%s\", \"ns_per_op\": %.3f, \"iterations\": %lld}%s\n", 
+			results_[i].name.c_str(), results_[i].ns_per_op, results_[i].iterations, i + 1 < results_.size() ? "," : "");
+	}
+
+	std::fputs("]}\n", file);
+	std::fclose(file);
+
+	return true;
+}
+
+std::vector<BenchResult> BenchSuite::ReadJson(const std::string& path)
+{
+	std::vector<BenchResult> results;
+	std::ifstream file(path);
+	std::string line;
+
+	while (std::getline(file, line))
+	{
+		const std::size_t name_start = line.find("\"name\": \"");
+
+		if (name_start == std::string::npos)
+		{
+			continue;
+		}
+
+		const std::size_t value_start = name_start + std::strlen("\"name\": \"");
+		const std::size_t value_end = line.find('"', value_start);
+		const std::size_t ns_start = line.find("\"ns_per_op\": ");
+
+		if (value_end == std::string::npos || ns_start == std::string::npos)
+		{
+			continue;
+		}
+
+		BenchResult result = { line.substr(value_start, value_end - value_start), 0.0, 0 };
+		result.ns_per_op = std::strtod(line.c_str() + ns_start + std::strlen("\"ns_per_op\": "), nullptr);
+		results.push_back(result);
+	}
+
+	return results;
+}
+
+bool BenchSuite::Compare(const std::string& path, double threshold_percent) const
+{
+	const std::vector<BenchResult> baseline = ReadJson(path);
+
+	if (baseline.empty())
+	{
+		printf("No baseline results in %s!\n", path.c_str());
+		return false;
+	}
+
+	bool passed = true;
+
+	printf("\n%-36s %14s %14s %9s\n", "benchmark", "baseline", "current", "change");
+
+	for (const BenchResult& result : results_)
+	{
+		const auto match = std::find_if(baseline.begin(), baseline.end(), [&result](const BenchResult& entry)
+		{
+			return entry.name == result.name;
+		});
+
+		if (match == baseline.end() || match->ns_per_op <= 0.0)
+		{
+			printf("%-36s %14s %14.2f %9s\n", result.name.c_str(), "-", result.ns_per_op, "new");
+			continue;
+		}
+
+		const double change = (result.ns_per_op / match->ns_per_op - 1.0) * 100.0;
+		const bool regressed = change > threshold_percent;
+
+		printf("%-36s %14.2f %14.2f %+8.1f%%%s\n", result.name.c_str(), match->ns_per_op, result.ns_per_op, change, regressed ? "  REGRESSED" : "");
+
+		passed = passed && !regressed;
+	}
+
+	if (!passed)
+	{
+		printf("\nOne or more benchmarks regressed by more than %.1f%%.\n", threshold_percent);
+	}
+
+	return passed;
+}
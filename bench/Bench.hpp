@@ -0,0 +1,82 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <functional>
+#include <string>
+#include <vector>
+
+struct BenchResult
+{
+	std::string name;
+	double ns_per_op;
+	long long iterations;
+};
+
+struct BenchOptions
+{
+	std::string filter;
+	std::string json_path;
+	std::string compare_path;
+	double threshold_percent;
+	double min_seconds;
+	int repetitions;
+};
+
+// Each case is timed over enough iterations to fill min_seconds, repeated, and reported as the
+// fastest repetition, which is the least noisy figure on a shared machine.
+class BenchSuite
+{
+private:
+	struct BenchCase
+	{
+		std::string name;
+		std::function<void(long long)> run;
+	};
+
+	std::vector<BenchCase> cases_;
+	std::vector<BenchResult> results_;
+
+public:
+	template <typename Function>
+	void Add(const char* name, Function function)
+	{
+		cases_.push_back({ name, [function](long long iterations) mutable
+		{
+			for (long long i = 0; i < iterations; ++i)
+			{
+				function();
+			}
+		} });
+	}
+
+	void Run(const BenchOptions& options);
+
+	bool WriteJson(const std::string& path) const;
+
+	// Returns false if any case is slower than its baseline by more than the threshold.
+	bool Compare(const std::string& path, double threshold_percent) const;
+
+	static std::vector<BenchResult> ReadJson(const std::string& path);
+};
+
+// Keeps the optimiser from discarding a value that a benchmark computes but never uses.
+template <typename T>
+inline void DoNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const T* sink;
+	sink = &value;
+#endif
+}
+
+void RegisterLevelBenches(BenchSuite& suite);
+
+void RegisterGhostBenches(BenchSuite& suite);
+
+void RegisterGameBenches(BenchSuite& suite);
+
+void RegisterVecEnvBenches(BenchSuite& suite);
+
+#endif
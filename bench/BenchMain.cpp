@@ -0,0 +1,69 @@
+#include "Bench.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char* argv[])
+{
+	BenchOptions options = { "", "", "", 10.0, 0.2, 5 };
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+		{
+			options.filter = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+		{
+			options.json_path = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--compare") == 0 && i + 1 < argc)
+		{
+			options.compare_path = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+		{
+			options.threshold_percent = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+		{
+			options.min_seconds = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc)
+		{
+			options.repetitions = std::atoi(argv[++i]);
+		}
+		else
+		{
+			printf("Usage: %s [--filter TEXT] [--json FILE] [--compare BASELINE [--threshold PERCENT]] [--min-time SECONDS] [--repetitions N]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	// Run anywhere: no display, no GPU. Explicit settings in the environment still win.
+	SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+	SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+
+	BenchSuite suite;
+	RegisterLevelBenches(suite);
+	RegisterGhostBenches(suite);
+	RegisterGameBenches(suite);
+	RegisterVecEnvBenches(suite);
+
+	suite.Run(options);
+
+	if (!options.json_path.empty() && !suite.WriteJson(options.json_path))
+	{
+		return 1;
+	}
+
+	if (!options.compare_path.empty() && !suite.Compare(options.compare_path, options.threshold_percent))
+	{
+		return 1;
+	}
+
+	return 0;
+}
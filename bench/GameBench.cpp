@@ -0,0 +1,177 @@
+#include "Bench.hpp"
+#include "Game.hpp"
+#include "Player.hpp"
+#include "Constants.hpp"
+#include "SoftwareRenderer.hpp"
+#include "ThreadPool.hpp"
+#include "TranspositionTable.hpp"
+#include "Zobrist.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// Ticks a headless game, steering the player at random once a second and restarting
+	// whenever a round ends, so the measurement never settles on a finished board.
+	struct TickFixture
+	{
+		Game game;
+		std::mt19937 rng;
+		std::uniform_int_distribution<int> direction;
+
+		TickFixture() : 
+			game(true), 
+			rng(1), 
+			direction(0, 3)
+		{
+		}
+
+		void Tick()
+		{
+			if (game.game_over_ || game.level_completed_)
+			{
+				game.Reset();
+			}
+
+			if (game.game_ticks_ % constants::tick_rate == 0)
+			{
+				game.GetPlayer()->SetDirection(static_cast<Direction>(direction(rng)));
+			}
+
+			game.Tick();
+		}
+	};
+}
+
+void RegisterGameBenches(BenchSuite& suite)
+{
+	const std::shared_ptr<TickFixture> ticks = std::make_shared<TickFixture>();
+
+	suite.Add("game_tick", [ticks]()
+	{
+		ticks->Tick();
+	});
+
+	suite.Add("game_logic_step", [ticks]()
+	{
+		for (int i = 0; i < constants::logic_step_ticks; ++i)
+		{
+			ticks->Tick();
+		}
+	});
+
+	const std::shared_ptr<TickFixture> swarm = std::make_shared<TickFixture>();
+	swarm->game.SetGhostCount(10000);
+
+	suite.Add("game_logic_step_swarm_10000", [swarm]()
+	{
+		for (int i = 0; i < constants::logic_step_ticks; ++i)
+		{
+			swarm->Tick();
+		}
+	});
+
+	// A search bot's inner loop: rewind to a saved state, then roll it forward with random input.
+	const std::shared_ptr<TickFixture> search = std::make_shared<TickFixture>();
+	const std::shared_ptr<GameState> root = std::make_shared<GameState>();
+	const std::shared_ptr<GameState> state = std::make_shared<GameState>();
+	search->game.Snapshot(*root);
+
+	suite.Add("game_state_snapshot_restore", [search, state]()
+	{
+		search->game.Snapshot(*state);
+		search->game.Restore(*state);
+	});
+
+	suite.Add("game_state_step", [search, root, state]()
+	{
+		if (state->game_over || state->level_completed || state->ghost_count == 0)
+		{
+			*state = *root;
+		}
+
+		search->game.Step(*state, static_cast<Direction>(search->direction(search->rng)));
+	});
+
+	// The desync check: tick, then recompute the hash from scratch and compare it with the kept one.
+	const std::shared_ptr<TickFixture> checked = std::make_shared<TickFixture>();
+	const std::shared_ptr<bool> desync_reported = std::make_shared<bool>(false);
+
+	suite.Add("game_state_hash_check", [checked, desync_reported]()
+	{
+		checked->Tick();
+
+		if (checked->game.GetStateHash() != checked->game.ComputeStateHash() && !*desync_reported)
+		{
+			printf("game_state_hash_check: state hash desync at tick %d!\n", checked->game.game_ticks_);
+			*desync_reported = true;
+		}
+	});
+
+	const std::shared_ptr<TranspositionTable> table = std::make_shared<TranspositionTable>(1 << 16);
+	const std::shared_ptr<std::uint64_t> probe = std::make_shared<std::uint64_t>(0);
+
+	suite.Add("transposition_store_probe", [table, probe]()
+	{
+		const std::uint64_t hash = zobrist::Key((*probe)++ % (1 << 17));
+		TranspositionEntry entry;
+
+		if (!table->Probe(hash, entry))
+		{
+			table->Store(hash, { 0, 1, Bound::EXACT, 0 });
+		}
+	});
+
+	// Frame capture for datasets: a headless game drawn on the CPU at full size, at full size with
+	// the rows split over every hardware thread, and at a quarter size in palette indices.
+	const std::shared_ptr<TickFixture> capture = std::make_shared<TickFixture>();
+	const std::shared_ptr<ThreadPool> capture_pool = std::make_shared<ThreadPool>(static_cast<int>(std::thread::hardware_concurrency()));
+	const std::shared_ptr<SoftwareRenderer> full_frame = std::make_shared<SoftwareRenderer>(1.0f, FrameFormat::RGBA);
+	const std::shared_ptr<SoftwareRenderer> parallel_frame = std::make_shared<SoftwareRenderer>(1.0f, FrameFormat::RGBA, capture_pool.get());
+	const std::shared_ptr<SoftwareRenderer> small_frame = std::make_shared<SoftwareRenderer>(0.25f, FrameFormat::INDEXED);
+	const std::shared_ptr<std::vector<std::uint8_t>> pixels = std::make_shared<std::vector<std::uint8_t>>(full_frame->GetFrameSize());
+
+	if (!capture->game.LoadHudFont())
+	{
+		printf("software_render benches run without HUD text: the font could not be loaded.\n");
+	}
+
+	suite.Add("software_render_frame", [capture, full_frame, pixels]()
+	{
+		capture->Tick();
+		capture->game.RenderSoftware(full_frame.get(), pixels->data());
+	});
+
+	suite.Add("software_render_frame_parallel", [capture, parallel_frame, capture_pool, pixels]()
+	{
+		capture->Tick();
+		capture->game.RenderSoftware(parallel_frame.get(), pixels->data());
+	});
+
+	suite.Add("software_render_frame_quarter_indexed", [capture, small_frame, pixels]()
+	{
+		capture->Tick();
+		capture->game.RenderSoftware(small_frame.get(), pixels->data());
+	});
+
+	// Rendering runs against whatever renderer SDL picks; the bench main selects the dummy video
+	// driver and the software renderer so this works without a display or GPU.
+	const std::shared_ptr<Game> render = std::make_shared<Game>(false);
+
+	if (render->renderer_ == nullptr)
+	{
+		printf("Skipping game_render: no renderer available.\n");
+		return;
+	}
+
+	render->SetFrameMode(FrameMode::UNCAPPED);
+
+	suite.Add("game_render", [render]()
+	{
+		render->Render();
+	});
+}
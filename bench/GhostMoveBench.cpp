@@ -0,0 +1,131 @@
+#include "Bench.hpp"
+#include "Game.hpp"
+#include "Level.hpp"
+#include "Ghost.hpp"
+#include "Tile.hpp"
+#include "Constants.hpp"
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace
+{
+	// The pre-table Ghost::Move: pixel-space neighbour lookups collected into a fresh vector.
+	struct LegacyGhost
+	{
+		int current_tile_;
+		int target_tile_;
+		Direction direction_;
+	};
+
+	int LegacyTileDistance(Level& level, int source, int target)
+	{
+		const SDL_Rect source_rect = level.GetTileRect(source);
+		const SDL_Rect target_rect = level.GetTileRect(target);
+		const int x_distance = std::abs(target_rect.x - source_rect.x) / level.GetTileSize();
+		const int y_distance = std::abs(target_rect.y - source_rect.y) / level.GetTileSize();
+
+		return x_distance + y_distance;
+	}
+
+	std::vector<int> LegacyGetNeighborTiles(Level& level, int x, int y)
+	{
+		return { level.GetLeftTile(x, y), level.GetRightTile(x, y), level.GetUpperTile(x, y), level.GetLowerTile(x, y) };
+	}
+
+	void LegacyMove(Level& level, LegacyGhost& ghost)
+	{
+		const SDL_Rect current_rect = level.GetTileRect(ghost.current_tile_);
+		const std::vector<int> neighbors = LegacyGetNeighborTiles(level, current_rect.x, current_rect.y);
+		int next_tile = -1;
+		Direction next_direction = Direction::NONE;
+
+		for (std::size_t i = 0; i < neighbors.size(); ++i)
+		{
+			if (neighbors[i] == -1 || level.IsWall(neighbors[i]))
+			{
+				continue;
+			}
+
+			const int dir = static_cast<int>(ghost.direction_);
+			const int current = static_cast<int>(i);
+
+			if ((dir == 1 && current == 0) || (dir == 0 && current == 1) || (dir == 2 && current == 3) || (dir == 3 && current == 2))
+			{
+				continue;
+			}
+
+			if (level.GetTileType(ghost.current_tile_) != TileType::GHOST_HOME && level.GetTileType(neighbors[i]) == TileType::GHOST_GATE)
+			{
+				continue;
+			}
+
+			if (level.GetTileType(ghost.current_tile_) == TileType::GHOST_CROSSROAD && i == 2)
+			{
+				continue;
+			}
+
+			if (next_tile == -1)
+			{
+				next_tile = neighbors[i];
+				next_direction = static_cast<Direction>(i);
+				continue;
+			}
+
+			if (LegacyTileDistance(level, neighbors[i], ghost.target_tile_) < LegacyTileDistance(level, ghost.current_tile_, ghost.target_tile_))
+			{
+				next_tile = neighbors[i];
+				next_direction = static_cast<Direction>(i);
+			}
+		}
+
+		if (next_tile != -1)
+		{
+			ghost.current_tile_ = next_tile;
+		}
+
+		ghost.direction_ = next_direction;
+	}
+}
+
+void RegisterGhostBenches(BenchSuite& suite)
+{
+	struct GhostFixture
+	{
+		Game game;
+		Level level;
+		LegacyGhost legacy;
+		Ghost ghost;
+
+		GhostFixture() : 
+			game(true), 
+			level(&game), 
+			legacy{ -1, -1, Direction::LEFT }, 
+			ghost(&game, &level, GhostType::BLINKY, 0)
+		{
+			level.Initialize(constants::level_path);
+
+			// Both versions start at Blinky's spawn heading for the home porch, so they walk the same route.
+			legacy = { level.GetTileIndex(352, 416), level.GetTileIndex(416, 352), Direction::LEFT };
+			ghost.Spawn();
+		}
+	};
+
+	const std::shared_ptr<GhostFixture> fixture = std::make_shared<GhostFixture>();
+
+	suite.Add("ghost_move_legacy", [fixture]()
+	{
+		LegacyMove(fixture->level, fixture->legacy);
+	});
+
+	suite.Add("ghost_move", [fixture]()
+	{
+		fixture->ghost.Move();
+	});
+
+	suite.Add("ghost_update_target_cells", [fixture]()
+	{
+		fixture->ghost.UpdateTargetCells();
+	});
+}
@@ -0,0 +1,151 @@
+#include "Bench.hpp"
+#include "MazeGenerator.hpp"
+#include "Game.hpp"
+#include "Level.hpp"
+#include "RouteTable.hpp"
+#include "Tile.hpp"
+#include "Constants.hpp"
+
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct LevelFixture
+	{
+		Game game;
+		Level level;
+		std::vector<SDL_Point> points;
+		std::vector<int> walkable;
+
+		LevelFixture() : 
+			game(true), 
+			level(&game)
+		{
+		}
+	};
+
+	std::shared_ptr<LevelFixture> MakeFixture(SDL_Surface* surface)
+	{
+		std::shared_ptr<LevelFixture> fixture = std::make_shared<LevelFixture>();
+
+		if (surface != nullptr)
+		{
+			fixture->level.Initialize(surface);
+		}
+		else
+		{
+			fixture->level.Initialize(constants::level_path);
+		}
+
+		std::mt19937 rng(1);
+		std::uniform_int_distribution<int> x(0, fixture->level.GetBoardWidth() - 1);
+		std::uniform_int_distribution<int> y(0, fixture->level.GetBoardHeight() - 1);
+
+		for (int i = 0; i < 1024; ++i)
+		{
+			fixture->points.push_back({ x(rng), y(rng) });
+		}
+
+		for (int i = 0; i < fixture->level.GetTileCount(); ++i)
+		{
+			if (!fixture->level.IsWall(i))
+			{
+				fixture->walkable.push_back(i);
+			}
+		}
+
+		return fixture;
+	}
+
+	void AddNeighborBench(BenchSuite& suite, const char* name, const std::shared_ptr<LevelFixture>& fixture)
+	{
+		std::size_t next = 0;
+
+		suite.Add(name, [fixture, next]() mutable
+		{
+			const std::array<int, 4> neighbors = fixture->level.GetNeighbors(fixture->walkable[next]);
+			DoNotOptimize(neighbors[0] + neighbors[1] + neighbors[2] + neighbors[3]);
+			next = next + 1 < fixture->walkable.size() ? next + 1 : 0;
+		});
+	}
+}
+
+void RegisterLevelBenches(BenchSuite& suite)
+{
+	const std::shared_ptr<LevelFixture> fixture = MakeFixture(nullptr);
+
+	// Shared so the generated surfaces outlive registration and are freed with the last lambda.
+	const std::shared_ptr<SDL_Surface> medium_maze(GenerateMaze(63, 63, 1), SDL_FreeSurface);
+	const std::shared_ptr<SDL_Surface> large_maze(GenerateMaze(255, 255, 1), SDL_FreeSurface);
+	const std::shared_ptr<SDL_Surface> huge_maze(GenerateMaze(1023, 1023, 1), SDL_FreeSurface);
+
+	suite.Add("level_initialize_default", [fixture]()
+	{
+		fixture->level.Initialize(constants::level_path);
+	});
+
+	const std::shared_ptr<std::string> compiled_path = std::make_shared<std::string>((std::filesystem::temp_directory_path() / "pacman_bench_default.lvl").string());
+	fixture->level.Save(compiled_path->c_str());
+
+	suite.Add("level_initialize_compiled", [fixture, compiled_path]()
+	{
+		fixture->level.Initialize(compiled_path->c_str());
+	});
+
+	suite.Add("level_initialize_generated_63", [fixture, medium_maze]()
+	{
+		fixture->level.Initialize(medium_maze.get());
+	});
+
+	suite.Add("level_initialize_generated_255", [fixture, large_maze]()
+	{
+		fixture->level.Initialize(large_maze.get());
+	});
+
+	suite.Add("level_initialize_generated_1023", [fixture, huge_maze]()
+	{
+		fixture->level.Initialize(huge_maze.get());
+	});
+
+	// Initialize benchmarks leave the fixture on whichever maze ran last; the queries get their own.
+	const std::shared_ptr<LevelFixture> queries = MakeFixture(nullptr);
+	const std::shared_ptr<LevelFixture> large_queries = MakeFixture(large_maze.get());
+
+	// Games on the same level share one route table, so the initialize benches reuse it; this is
+	// the build the first game on a level pays for.
+	suite.Add("route_table_build_default", [queries]()
+	{
+		RouteTable table;
+		DoNotOptimize(table.Build(&queries->level));
+	});
+
+	std::size_t next = 0;
+
+	suite.Add("level_get_tile", [queries, next]() mutable
+	{
+		const SDL_Point& point = queries->points[next];
+		DoNotOptimize(queries->level.GetTileIndex(point.x, point.y));
+		next = (next + 1) & 1023;
+	});
+
+	suite.Add("level_neighbors_pixel", [queries, next]() mutable
+	{
+		const SDL_Point& point = queries->points[next];
+		DoNotOptimize(queries->level.GetLeftTile(point.x, point.y));
+		DoNotOptimize(queries->level.GetRightTile(point.x, point.y));
+		DoNotOptimize(queries->level.GetUpperTile(point.x, point.y));
+		DoNotOptimize(queries->level.GetLowerTile(point.x, point.y));
+		next = (next + 1) & 1023;
+	});
+
+	AddNeighborBench(suite, "level_neighbors_table", queries);
+	AddNeighborBench(suite, "level_neighbors_table_generated_255", large_queries);
+
+	// Past constants::max_neighbor_table_tiles the neighbours are worked out from the index instead.
+	const std::shared_ptr<SDL_Surface> computed_maze(GenerateMaze(2047, 2047, 1), SDL_FreeSurface);
+	AddNeighborBench(suite, "level_neighbors_computed_2047", MakeFixture(computed_maze.get()));
+}
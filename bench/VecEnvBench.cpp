@@ -0,0 +1,55 @@
+#include "Bench.hpp"
+#include "VecEnv.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// One batched step of every environment with random actions, on all hardware threads.
+	struct VecEnvFixture
+	{
+		VecEnv env;
+		std::vector<std::uint8_t> observations;
+		std::vector<std::uint8_t> actions;
+		std::vector<float> rewards;
+		std::vector<std::uint8_t> dones;
+		std::mt19937 rng;
+
+		explicit VecEnvFixture(int env_count) : 
+			env(env_count, static_cast<int>(std::thread::hardware_concurrency())), 
+			actions(static_cast<std::size_t>(env_count)), 
+			rewards(static_cast<std::size_t>(env_count)), 
+			dones(static_cast<std::size_t>(env_count)), 
+			rng(1)
+		{
+		}
+	};
+}
+
+void RegisterVecEnvBenches(BenchSuite& suite)
+{
+	const std::shared_ptr<VecEnvFixture> fixture = std::make_shared<VecEnvFixture>(1024);
+
+	if (!fixture->env.Initialize())
+	{
+		printf("Skipping vec_env_step_1024: environments could not be set up.\n");
+		return;
+	}
+
+	fixture->observations.resize(fixture->env.GetObservationSize() * fixture->env.GetEnvCount());
+	fixture->env.Reset(fixture->observations.data());
+
+	suite.Add("vec_env_step_1024", [fixture]()
+	{
+		for (std::uint8_t& action : fixture->actions)
+		{
+			action = static_cast<std::uint8_t>(fixture->rng() % 5);
+		}
+
+		fixture->env.Step(fixture->actions.data(), fixture->observations.data(), fixture->rewards.data(), fixture->dones.data());
+	});
+}
@@ -0,0 +1,59 @@
+#ifndef BATCH_RUNNER_HPP
+#define BATCH_RUNNER_HPP
+
+#include "InputScript.hpp"
+#include "ThreadPool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct BatchJob
+{
+	std::uint32_t seed;
+	int ticks;
+	InputScript script;
+	std::string replay_path;
+	std::string level_path;
+	int ghost_count;
+};
+
+struct BatchResult
+{
+	// Where the job was in the list given to Run.
+	std::size_t job;
+	std::uint32_t seed;
+	int score;
+	int lives;
+	int levels_cleared;
+	int game_ticks;
+	int resets;
+
+	// False if the job's level or replay could not be loaded; the other counts are then meaningless.
+	bool loaded;
+
+	// False if the game's incrementally kept state hash no longer matched a recomputed one at the end.
+	bool hash_matches;
+};
+
+class BatchRunner
+{
+private:
+	ThreadPool pool_;
+	double last_run_seconds_;
+	std::size_t last_run_games_;
+
+public:
+	explicit BatchRunner(int thread_count);
+
+	~BatchRunner();
+
+	std::vector<BatchResult> Run(const std::vector<BatchJob>& jobs);
+
+	void PrintReport();
+
+	static InputScript MakeRandomScript(std::uint32_t seed, int ticks);
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef BITSET_HPP
+#define BITSET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One bit per tile in 64-bit words, so copying or counting a whole board goes a word at a time.
+class Bitset
+{
+private:
+	std::vector<std::uint64_t> words_;
+
+public:
+	void Resize(std::size_t size)
+	{
+		words_.assign((size + 63) / 64, 0);
+	}
+
+	bool Test(std::size_t index) const
+	{
+		return (words_[index / 64] >> (index % 64)) & 1;
+	}
+
+	void Set(std::size_t index)
+	{
+		words_[index / 64] |= std::uint64_t{ 1 } << (index % 64);
+	}
+
+	void Clear(std::size_t index)
+	{
+		words_[index / 64] &= ~(std::uint64_t{ 1 } << (index % 64));
+	}
+
+	int Count() const
+	{
+		int count = 0;
+
+		for (const std::uint64_t word : words_)
+		{
+			count += __builtin_popcountll(word);
+		}
+
+		return count;
+	}
+
+	std::uint64_t* GetWords()
+	{
+		return words_.data();
+	}
+
+	const std::uint64_t* GetWords() const
+	{
+		return words_.data();
+	}
+
+	std::size_t GetWordCount() const
+	{
+		return words_.size();
+	}
+};
+
+#endif
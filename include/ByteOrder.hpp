@@ -0,0 +1,27 @@
+#ifndef BYTE_ORDER_HPP
+#define BYTE_ORDER_HPP
+
+#include <cstdint>
+
+// File formats are little-endian regardless of the host.
+inline void WriteLittleEndian(std::uint8_t* out, std::uint64_t value, int bytes)
+{
+	for (int i = 0; i < bytes; ++i)
+	{
+		out[i] = static_cast<std::uint8_t>(value >> (8 * i));
+	}
+}
+
+inline std::uint64_t ReadLittleEndian(const std::uint8_t* in, int bytes)
+{
+	std::uint64_t value = 0;
+
+	for (int i = 0; i < bytes; ++i)
+	{
+		value |= static_cast<std::uint64_t>(in[i]) << (8 * i);
+	}
+
+	return value;
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef CAMERA_HPP
+#define CAMERA_HPP
+
+#include <SDL2/SDL.h>
+
+// The part of the board shown in the board viewport, in board pixels. It centres on its target
+// and stops at the board's edges; a board smaller than the view is centred in it instead.
+class Camera
+{
+private:
+	SDL_Rect view_;
+
+public:
+	Camera();
+
+	~Camera();
+
+	void SetSize(int width, int height);
+
+	void Follow(const SDL_Rect& target, int board_width, int board_height);
+
+	const SDL_Rect& GetView() const;
+
+	bool IsVisible(const SDL_Rect& rect) const;
+
+	// Columns and rows of a tile_size grid that the view overlaps, clamped to the grid, in tiles.
+	SDL_Rect GetVisibleTiles(int tile_size, int columns, int rows) const;
+};
+
+#endif
@@ -10,6 +10,26 @@ namespace constants
 	inline constexpr int board_height = 992;
 	inline constexpr int info_width = 896;
 	inline constexpr int info_height = 160;
+	inline constexpr char level_path[] = "res/levels/default.png";
+	inline constexpr char compiled_level_path[] = "res/levels/default.lvl";
+	inline constexpr int max_level_size = 8192;
+	inline constexpr int max_route_table_bytes = 256 * 1024;
+	inline constexpr int max_neighbor_table_tiles = 1 << 20;
+	inline constexpr int max_maze_texture_size = 4096;
+	inline constexpr int starting_lives = 5;
+	inline constexpr int default_ghost_count = 4;
+	inline constexpr int max_ghost_count = 65535;
+	inline constexpr int swarm_spawn_distance = 8;
+	inline constexpr int tick_rate = 60;
+	inline constexpr int logic_step_ticks = 20;
+	inline constexpr int scatter_ticks = 7 * tick_rate;
+	inline constexpr int chase_ticks = 20 * tick_rate;
+	inline constexpr double max_catch_up_seconds = 0.25;
+	inline constexpr int idle_wait_ms = 250;
+	inline constexpr int rewind_keyframe_steps = 6;
+	inline constexpr int metrics_interval_ms = 1000;
+	inline constexpr float metrics_text_scale = 0.5f;
+	inline constexpr int trace_buffer_events = 1 << 16;
 } // namespace constants
 
 #endif
\ No newline at end of file
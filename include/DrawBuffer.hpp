@@ -0,0 +1,79 @@
+#ifndef DRAW_BUFFER_HPP
+#define DRAW_BUFFER_HPP
+
+#include <SDL2/SDL.h>
+
+#include <cstdint>
+#include <vector>
+
+// Layers are flushed bottom to top. Within the maze, pellet and HUD layers, whose draws never
+// overlap, commands are regrouped by texture and colour; the rest keep their recording order, so
+// the last ghost recorded is the one on top.
+enum class DrawLayer
+{
+	MAZE, PELLETS, DEBUG, PLAYER, GHOSTS, HUD
+};
+
+struct DrawCommand
+{
+	DrawLayer layer;
+	SDL_Texture* texture;
+	std::uint32_t color;
+	SDL_Rect source;
+	SDL_Rect destination;
+	bool full_source;
+};
+
+struct DrawStats
+{
+	int commands;
+	int draw_calls;
+	int state_changes;
+};
+
+class DrawBuffer
+{
+private:
+	std::vector<DrawCommand> commands_;
+	std::vector<SDL_Rect> rects_;
+	std::vector<SDL_Vertex> vertices_;
+	std::vector<int> indices_;
+
+	DrawStats frame_stats_;
+	DrawStats last_frame_stats_;
+
+	int origin_x_;
+	int origin_y_;
+
+	void FlushRects(SDL_Renderer* renderer, std::size_t begin, std::size_t end);
+
+	void FlushTextures(SDL_Renderer* renderer, std::size_t begin, std::size_t end);
+
+public:
+	DrawBuffer();
+
+	~DrawBuffer();
+
+	void BeginFrame();
+
+	// Recorded destinations are relative to this point, so board entities can draw in board pixels.
+	void SetOrigin(int x, int y);
+
+	void FillRect(DrawLayer layer, const SDL_Rect& rect, Uint8 r, Uint8 g, Uint8 b, Uint8 a = 0xff);
+
+	void CopyTexture(DrawLayer layer, SDL_Texture* texture, const SDL_Rect* source, const SDL_Rect& destination, const SDL_Color& color = { 0xff, 0xff, 0xff, 0xff });
+
+	void Flush(SDL_Renderer* renderer);
+
+	// Hands the recorded commands over unsorted, for drawing without a renderer, and empties the buffer.
+	void TakeCommands(std::vector<DrawCommand>& commands);
+
+	const DrawStats& GetFrameStats() const;
+
+	// The flush order, for a stable sort of recorded commands.
+	static bool DrawsBefore(const DrawCommand& lhs, const DrawCommand& rhs);
+
+	const DrawStats& GetLastFrameStats() const;
+};
+
+#endif
@@ -21,7 +21,7 @@ protected:
 	Level* level_;
 
 	Direction direction_;
-	Tile* current_tile_;
+	int current_tile_;
 
 public:
 	Entity(Game* game);
@@ -30,7 +30,7 @@ public:
 
 	void SetLevel(Level* level);
 	
-	Tile* GetCurrentTile();
+	int GetCurrentTile();
 	
 	Direction GetDirection();
 
@@ -0,0 +1,45 @@
+#ifndef FLOW_FIELD_HPP
+#define FLOW_FIELD_HPP
+
+#include <limits>
+#include <vector>
+
+class Level;
+
+// Every tile's distance to one target under the ghost move rules. All ghosts chasing that target
+// share it, so each picks its next step with four lookups however many ghosts there are.
+class FlowField
+{
+private:
+	std::vector<int> distance_;
+	std::vector<int> queue_;
+	int target_;
+
+public:
+	static constexpr int unreachable = std::numeric_limits<int>::max() / 2;
+
+	FlowField();
+
+	~FlowField();
+
+	// Rebuilds the field when the target differs from the last one; otherwise does nothing.
+	void Update(Level* level, int target);
+
+	void Clear();
+
+	int GetTarget() const;
+
+	int GetDistance(int tile) const;
+};
+
+inline int FlowField::GetTarget() const
+{
+	return target_;
+}
+
+inline int FlowField::GetDistance(int tile) const
+{
+	return distance_[tile];
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef FRAME_SCHEDULER_HPP
+#define FRAME_SCHEDULER_HPP
+
+#include <cstdint>
+#include <ctime>
+
+enum class FrameMode
+{
+	VSYNC, 
+	CAPPED, 
+	UNCAPPED
+};
+
+struct FrameStats
+{
+	std::uint64_t frames;
+	std::uint64_t idle_frames;
+	std::uint64_t dropped_ticks;
+	double wall_seconds;
+	double cpu_seconds;
+	double max_cpu_seconds;
+};
+
+// Decides how many simulation ticks each frame runs and paces frames in CAPPED mode.
+class FrameScheduler
+{
+private:
+	FrameMode mode_;
+	double target_fps_;
+
+	std::uint64_t frequency_;
+	std::uint64_t frame_period_;
+	std::uint64_t sleep_margin_;
+	std::uint64_t last_time_;
+	std::uint64_t frame_start_;
+	std::uint64_t next_deadline_;
+	std::clock_t cpu_start_;
+
+	long double accumulator_;
+
+	FrameStats stats_;
+
+	void Pace();
+
+public:
+	FrameScheduler();
+
+	void SetMode(FrameMode mode, double target_fps);
+
+	FrameMode GetMode();
+
+	double GetTargetFps();
+
+	void Resync();
+
+	void BeginFrame(bool idle = false);
+
+	int TicksDue(double speed);
+
+	void EndFrame();
+
+	const FrameStats& GetStats();
+
+	void ResetStats();
+};
+
+#endif
@@ -2,14 +2,25 @@
 #define GAME_HPP
 
 #include "Texture.hpp"
+#include "DrawBuffer.hpp"
+#include "Camera.hpp"
+#include "FrameScheduler.hpp"
+#include "Metrics.hpp"
+#include "GlyphAtlas.hpp"
 #include "Tile.hpp"
 #include "Level.hpp"
 #include "Player.hpp"
 #include "Ghost.hpp"
+#include "InputScript.hpp"
+#include "Replay.hpp"
+#include "GameState.hpp"
+#include "Rewind.hpp"
+#include "SoftwareRenderer.hpp"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <array>
@@ -19,6 +30,11 @@ class Game
 private:
 	bool running_;
 	bool initialized_;
+	bool headless_;
+	double speed_;
+	int resets_;
+	std::uint64_t hash_;
+	std::uint64_t pellet_hash_;
 
 public:
 	bool game_over_;
@@ -28,28 +44,55 @@ public:
 	int lives_;
 	int levels_cleared_;
 	int game_ticks_;
-	double mode_timer_;
+
+	// Simulation ticks, not logic steps, since the last scatter/chase switch; compared against
+	// constants::scatter_ticks and chase_ticks, which are in the same unit.
+	int mode_ticks_;
 
 private:
 	std::unique_ptr<Level> level_;
 	std::unique_ptr<Player> player_;
-	std::vector<std::unique_ptr<Ghost>> ghosts_;
+	std::vector<Ghost> ghosts_;
+
+	std::unique_ptr<GlyphAtlas> glyph_atlas_;
+	TextLayout game_over_text_;
+	TextLayout level_completed_text_;
+	HudCounter score_text_;
+	HudCounter lives_text_;
+	HudCounter levels_cleared_text_;
+
+	std::unique_ptr<DrawBuffer> draw_buffer_;
+	std::unique_ptr<Camera> camera_;
+	std::unique_ptr<FrameScheduler> frame_scheduler_;
 
-	std::unique_ptr<Texture> game_over_texture_;
-	std::unique_ptr<Texture> level_completed_texture_;
-	std::unique_ptr<Texture> score_texture_;
-	std::unique_ptr<Texture> lives_texture_;
-	std::unique_ptr<Texture> levels_cleared_texture_;
+	std::unique_ptr<Metrics> metrics_;
+	std::vector<TextLayout> metrics_text_;
+	std::uint64_t metrics_generation_;
+	bool metrics_overlay_;
+
+	std::unique_ptr<ReplayRecorder> recorder_;
+	std::unique_ptr<Rewind> rewind_;
+	std::unique_ptr<ReplayReader> replay_;
 
 	SDL_Rect board_viewport_;
 	SDL_Rect info_viewport_;
 
+	// Rebuilds the level's occupancy grid from scratch after entities spawn.
+	void PlaceOccupants();
+
+	// Records the level, player and visible ghosts into the draw buffer, in board pixels, with the
+	// camera following the player.
+	void RecordBoard(bool use_maze_texture);
+
+	// The part of the state hash that is not pellets, worked out from scratch.
+	std::uint64_t HashEntities();
+
 public:
 	SDL_Window* window_;
 	SDL_Renderer* renderer_;
 	TTF_Font* font_;
 
-	Game();
+	Game(bool headless = false);
 
 	~Game();
 
@@ -67,19 +110,94 @@ public:
 
 	void RenderInfo();
 
+	void RenderMetrics();
+
+	// Draws the frame Render would show, without the metrics overlay, into pixels through renderer.
+	// Headless games draw no HUD text until LoadHudFont has succeeded.
+	void RenderSoftware(SoftwareRenderer* renderer, std::uint8_t* pixels);
+
+	// Opens the HUD font for a headless game, which skips it at start-up; windowed games already have it.
+	bool LoadHudFont();
+
 	void Run();
 
+	void RunHeadless(int ticks, const InputScript& script = {}, bool auto_reset = true);
+
+	int Simulate(int ticks, const InputScript& script, bool auto_reset = true);
+
+	void ApplyInput(const InputEvent& event);
+
+	void RecordInput(const InputEvent& event);
+
+	void StartRecording();
+
+	bool SaveRecording(const char* path);
+
+	bool LoadLevel(const char* path);
+
+	// The first four ghosts are Blinky, Inky, Pinky and Clyde; the rest are swarm ghosts spread
+	// over the board. count must be between one and max_ghost_count.
+	void SetGhostCount(int count);
+
+	int GetGhostCount();
+
+	// Copies the game into state. Fails, leaving state untouched, if the level has more than
+	// GameState::max_tiles tiles or there are more than GameState::max_ghosts ghosts.
+	bool Snapshot(GameState& state);
+
+	void Restore(const GameState& state);
+
+	// Advances state by one logic step with the player steering towards input (NONE keeps going).
+	// The result depends only on state, input and the level: this game is overwritten on the way,
+	// so searches should step a headless Game of their own. Its rewind history, recording and
+	// replay are left alone while stepping.
+	void Step(GameState& state, Direction input);
+
+	// A 64-bit Zobrist hash of the pellets and energizers left, the player's tile and directions,
+	// every ghost's tile, direction and mode, and the mode timer. It is kept up to date as they
+	// change; score, lives and the tick counter are not part of it.
+	std::uint64_t GetStateHash() const;
+
+	// Works the hash out from scratch, to check the incremental one.
+	std::uint64_t ComputeStateHash();
+
+	void ToggleHash(std::uint64_t key);
+
+	void TogglePelletHash(std::uint64_t key);
+
+	// Keeps the last seconds of play for RewindTo. Needs a game GameState can hold.
+	bool StartRewind(int seconds);
+
+	// Puts the game back to how it was at tick, which must be within the rewind buffer.
+	bool RewindTo(int tick);
+
+	Rewind* GetRewind();
+
+	bool LoadReplay(const char* path);
+
+	int GetReplayLength();
+
+	void SetSpeed(double speed);
+
+	void SetFrameMode(FrameMode mode, double target_fps = 0.0);
+
 	void Stop();
 
 	void Reset(bool reset_pellets = true);
 
-	void UpdateScoreTexture();
-	
-	void UpdateLivesTexture();
-	
-	void UpdateLevelsClearedTexture();
-	
 	Player* GetPlayer();
+
+	DrawBuffer* GetDrawBuffer();
+
+	Camera* GetCamera();
+
+	Level* GetLevel();
+
+	const DrawStats& GetDrawStats();
+
+	const FrameStats& GetFrameStats();
+
+	Metrics* GetMetrics();
 };
 
 #endif
\ No newline at end of file
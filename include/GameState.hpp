@@ -0,0 +1,55 @@
+#ifndef GAME_STATE_HPP
+#define GAME_STATE_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+struct PlayerState
+{
+	std::int32_t tile;
+	std::uint8_t direction;
+	std::uint8_t queued_direction;
+};
+
+struct GhostState
+{
+	std::int32_t tile;
+	std::int32_t target_tile;
+	std::uint8_t direction;
+	std::uint8_t mode;
+};
+
+// Everything that changes while a game is played, with no pointers, so a copy is a complete and
+// independent game. Anything fixed by the level and the ghost count (walls, spawns, scatter
+// corners) stays with the Game. Sized for the classic game: up to max_tiles tiles and max_ghosts ghosts.
+struct GameState
+{
+	static constexpr int max_tiles = 1024;
+	static constexpr int max_ghosts = 4;
+	static constexpr int bitset_words = max_tiles / 64;
+
+	// The game's Zobrist hash and its pellet and energizer part, restored as they are rather than
+	// recomputed from the board.
+	std::uint64_t hash;
+	std::uint64_t pellet_hash;
+
+	std::int32_t score;
+	std::int32_t lives;
+	std::int32_t levels_cleared;
+	std::int32_t game_ticks;
+	std::int32_t mode_ticks;
+	std::int32_t collectibles_left;
+	std::uint8_t game_over;
+	std::uint8_t level_completed;
+	std::uint16_t ghost_count;
+
+	PlayerState player;
+	GhostState ghosts[max_ghosts];
+
+	std::uint64_t pellets[bitset_words];
+	std::uint64_t energizers[bitset_words];
+};
+
+static_assert(std::is_trivially_copyable<GameState>::value, "GameState must stay copyable with memcpy");
+
+#endif
@@ -2,12 +2,13 @@
 #define GHOST_HPP
 
 #include "Entity.hpp"
+#include "GameState.hpp"
 
 #include <SDL2/SDL.h>
 
 enum class GhostType
 {
-	BLINKY, INKY, PINKY, CLYDE
+	BLINKY, INKY, PINKY, CLYDE, SWARM
 };
 
 enum class GhostMode
@@ -21,13 +22,18 @@ public:
 	GhostType type_;
 	GhostMode mode_;
 private:
-	Tile* target_tile_;
-	Tile* scatter_target_tile_;
-	Tile* home_porch_target_tile_;
-	Tile* home_target_tile_;
+	int target_tile_;
+	int scatter_target_tile_;
+	int home_porch_target_tile_;
+	int home_target_tile_;
+	int spawn_tile_;
+	int index_;
 
 public:
-	Ghost(Game* game, Level* level, GhostType type);
+	// Swarm ghosts start on spawn_tile and scatter to the board corner nearest it; the four
+	// classic ghosts use the level's spawn points. index is the ghost's place in the game, which
+	// keeps its Zobrist keys apart from every other ghost's.
+	Ghost(Game* game, Level* level, GhostType type, int index, int spawn_tile = -1);
 
 	~Ghost() override;
 
@@ -38,8 +44,19 @@ public:
 	void Render() override;
 
 	void Move();
+
+	bool CanMove(Direction direction);
 	
 	void UpdateTargetCells();
+
+	void SetMode(GhostMode mode);
+
+	// XOR of the Zobrist keys for the ghost's tile, direction and mode.
+	std::uint64_t GetHashKey() const;
+
+	void Snapshot(GhostState& state) const;
+
+	void Restore(const GhostState& state);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,81 @@
+#ifndef GLYPH_ATLAS_HPP
+#define GLYPH_ATLAS_HPP
+
+#include "Texture.hpp"
+#include "DrawBuffer.hpp"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct GlyphQuad
+{
+	SDL_Rect source;
+	SDL_Rect destination;
+};
+
+struct TextLayout
+{
+	std::vector<GlyphQuad> quads;
+	int width;
+	int height;
+};
+
+class GlyphAtlas
+{
+private:
+	static constexpr int first_glyph = 32;
+	static constexpr int glyph_count = 95;
+
+	std::unique_ptr<Texture> texture_;
+	std::array<SDL_Rect, glyph_count> glyphs_;
+	std::array<int, glyph_count> offsets_;
+	std::array<int, glyph_count> advances_;
+	int line_height_;
+
+	// The atlas's alpha, one byte per texel, for drawing text without a renderer.
+	std::vector<std::uint8_t> coverage_;
+	int coverage_width_;
+
+public:
+	GlyphAtlas();
+
+	~GlyphAtlas();
+
+	// With a null renderer only the coverage is built, for software rendering.
+	bool Build(SDL_Renderer* renderer, TTF_Font* font);
+
+	void Free();
+
+	void Layout(const char* text, TextLayout& layout, float scale = 1.0f) const;
+
+	void Render(DrawBuffer* draw_buffer, const TextLayout& layout, int x, int y, const SDL_Color& color) const;
+
+	// Empty until Build has succeeded.
+	const std::vector<std::uint8_t>& GetCoverage() const;
+
+	int GetCoverageWidth() const;
+};
+
+// A "label: value" HUD line that is only laid out again when its value changes.
+class HudCounter
+{
+private:
+	std::string label_;
+	std::string text_;
+	TextLayout layout_;
+	int value_;
+	bool laid_out_;
+
+public:
+	explicit HudCounter(const char* label);
+
+	const TextLayout& Update(const GlyphAtlas& atlas, int value);
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef INPUT_SCRIPT_HPP
+#define INPUT_SCRIPT_HPP
+
+#include "Entity.hpp"
+
+#include <vector>
+
+enum class InputType
+{
+	DIRECTION, RESET
+};
+
+struct InputEvent
+{
+	int tick;
+	InputType type;
+	Direction direction;
+};
+
+// Events are applied in order, each right before the Tick() whose game_ticks_ matches.
+using InputScript = std::vector<InputEvent>;
+
+#endif
@@ -2,61 +2,167 @@
 #define LEVEL_HPP
 
 #include "Tile.hpp"
+#include "Entity.hpp"
+#include "Texture.hpp"
+#include "Bitset.hpp"
+#include "FlowField.hpp"
+#include "OccupancyGrid.hpp"
+#include "GameState.hpp"
+#include "RouteTable.hpp"
 
 #include <SDL2/SDL.h>
 
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 class Game;
+class DrawBuffer;
+
+enum class SpawnPoint
+{
+	PLAYER, BLINKY, INKY, PINKY, CLYDE, HOME_PORCH, COUNT
+};
 
 class Level
 {
 private:
 	Game* game_;
-	SDL_Surface* surface_pixels_;
-	Uint32* pixels_;
 
-	std::vector<Tile> board_;
+	// A TileType per tile, plus where pellets and energizers start and which are still uneaten.
+	std::vector<std::uint8_t> tiles_;
+	Bitset pellets_;
+	Bitset energizers_;
+	Bitset pellets_present_;
+	Bitset energizers_present_;
+	// Four neighbours per tile in Direction order, kept only on boards of up to
+	// constants::max_neighbor_table_tiles; larger boards work them out from the index.
+	std::vector<int> neighbors_;
+	std::unique_ptr<Texture> maze_texture_;
 	int pixel_width_;
 	int pixel_height_;
 	int pixel_count_;
 	int tile_size_;
 
-public:
-	int pellet_count_;
-	int energizer_count_;
+	std::shared_ptr<const RouteTable> routes_;
+
+	std::unique_ptr<FlowField> flow_field_;
+	std::unique_ptr<OccupancyGrid> occupancy_;
+
+	int collectibles_total_;
+	int collectibles_left_;
+	std::uint64_t hash_;
+	std::uint64_t pellet_hash_;
+	std::array<int, static_cast<int>(SpawnPoint::COUNT)> spawns_;
+
+	bool LoadCompiled(const char* path);
+
+	void PlaceSpawns();
+
+	int FindOpenTile(int index);
+
+	void Build();
 
+	std::uint64_t ComputeHash();
+
+	void RenderStatic(int index, DrawBuffer* draw_buffer);
+
+	std::array<int, 4> ComputeNeighbors(int index) const;
+
+	void RenderPellet(int index);
+
+public:
 	Level(Game* game);
 
 	~Level();
 
 	void HandleEvents();
 	
-	void Tick();
-	
-	void Render();
+	// Without the maze texture the walls are drawn tile by tile, as rectangle fills.
+	void Render(bool use_maze_texture = true);
 
 	bool Load(const char* path);
 
-	void Initialize(const char* path);
+	bool Load(SDL_Surface* surface);
+
+	// Paths ending in .lvl are read as compiled levels, anything else is decoded as an image.
+	bool Initialize(const char* path);
+
+	bool Initialize(SDL_Surface* surface);
+
+	bool Save(const char* path);
 
 	void Free();
 
 	void Reset();
 
-	int TileDistance(const Tile& source, const Tile& target);
+	void EatPellet(int index);
 
-	Tile* GetTile(int x, int y);
-	
-	Tile* GetUpperTile(int x, int y);
+	void EatEnergizer(int index);
+
+	// Copy the uneaten pellets and energizers out of and back into a state; the level must fit in one.
+	void Snapshot(GameState& state) const;
+
+	void Restore(const GameState& state);
+
+	bool BuildMazeTexture();
+
+	void BuildNeighborTable();
+
+	void BuildRouteTable();
+
+	bool CanGhostStep(int source, Direction direction);
+
+	bool HasRoutes() const;
+
+	void UpdateFlowField(int target);
+
+	const FlowField* GetFlowField() const;
+
+	OccupancyGrid* GetOccupancy();
+
+	// The direction that steps from source onto the neighbouring target, or NONE if they are not neighbours.
+	Direction GetStepDirection(int source, int target) const;
+
+	std::uint8_t GetRoute(int source, int target) const;
+
+	int TileDistance(int source, int target);
+
+	int GetTileIndex(int x, int y);
+
+	int GetTileCount();
+
+	std::uint64_t GetHash() const;
+
+	// XOR of the Zobrist keys of every pellet and energizer the level starts with.
+	std::uint64_t GetPelletHash() const;
+
+	TileType GetTileType(int index) const;
+
+	bool IsWall(int index) const;
+
+	bool HasPellet(int index) const;
+
+	bool HasEnergizer(int index) const;
+
+	SDL_Rect GetTileRect(int index) const;
+
+	int GetPelletCount() const;
+
+	int GetEnergizerCount() const;
+
+	int GetNeighbor(int index, Direction direction) const;
+
+	std::array<int, 4> GetNeighbors(int index) const;
+
+	int GetUpperTile(int x, int y);
 	
-	Tile* GetLowerTile(int x, int y);
+	int GetLowerTile(int x, int y);
 	
-	Tile* GetLeftTile(int x, int y);
+	int GetLeftTile(int x, int y);
 	
-	Tile* GetRightTile(int x, int y);
-
-	std::vector<Tile*> GetNeighborTiles(int x, int y);
+	int GetRightTile(int x, int y);
 
 	int GetPixelWidth();
 	
@@ -64,11 +170,96 @@ public:
 	
 	int GetPixelCount();
 
-	SDL_Surface* GetPixelSurface();
+	int GetBoardWidth();
+
+	int GetBoardHeight();
 
-	Uint32* GetPixels32();
+	int GetTileSize();
 
-	Uint32 GetPitch32();
+	int GetSpawn(SpawnPoint spawn);
 };
 
+inline TileType Level::GetTileType(int index) const
+{
+	return static_cast<TileType>(tiles_[index]);
+}
+
+inline bool Level::IsWall(int index) const
+{
+	return tiles_[index] == static_cast<std::uint8_t>(TileType::WALL);
+}
+
+inline bool Level::HasPellet(int index) const
+{
+	return pellets_present_.Test(index);
+}
+
+inline bool Level::HasEnergizer(int index) const
+{
+	return energizers_present_.Test(index);
+}
+
+// Tiles are laid out row by row from the board's top-left corner, tile_size_ pixels apart.
+inline SDL_Rect Level::GetTileRect(int index) const
+{
+	return { (index % pixel_width_) * tile_size_, (index / pixel_width_) * tile_size_, tile_size_, tile_size_ };
+}
+
+// The board wraps around on every edge, which is what makes the side tunnels work.
+inline std::array<int, 4> Level::ComputeNeighbors(int index) const
+{
+	const int x = index % pixel_width_;
+
+	return 
+	{
+		x == 0 ? index + pixel_width_ - 1 : index - 1, 
+		x == pixel_width_ - 1 ? index - x : index + 1, 
+		index < pixel_width_ ? index + pixel_count_ - pixel_width_ : index - pixel_width_, 
+		index >= pixel_count_ - pixel_width_ ? index + pixel_width_ - pixel_count_ : index + pixel_width_
+	};
+}
+
+inline int Level::GetNeighbor(int index, Direction direction) const
+{
+	if (neighbors_.empty())
+	{
+		return ComputeNeighbors(index)[static_cast<int>(direction)];
+	}
+
+	return neighbors_[index * 4 + static_cast<int>(direction)];
+}
+
+inline std::array<int, 4> Level::GetNeighbors(int index) const
+{
+	if (neighbors_.empty())
+	{
+		return ComputeNeighbors(index);
+	}
+
+	const int* entry = &neighbors_[index * 4];
+
+	return { entry[0], entry[1], entry[2], entry[3] };
+}
+
+inline bool Level::HasRoutes() const
+{
+	return routes_ != nullptr;
+}
+
+inline const FlowField* Level::GetFlowField() const
+{
+	return flow_field_.get();
+}
+
+inline OccupancyGrid* Level::GetOccupancy()
+{
+	return occupancy_.get();
+}
+
+// Packs the four directions out of source, best first, two bits each starting at the low bits.
+inline std::uint8_t Level::GetRoute(int source, int target) const
+{
+	return routes_->GetRoute(source, target);
+}
+
 #endif
@@ -0,0 +1,35 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Read-only view of a whole file: memory-mapped where the platform allows, read into memory otherwise.
+class MappedFile
+{
+private:
+	const std::uint8_t* data_;
+	std::size_t size_;
+	bool mapped_;
+	std::vector<std::uint8_t> buffer_;
+
+public:
+	MappedFile();
+
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Open(const char* path);
+
+	void Close();
+
+	const std::uint8_t* GetData() const;
+
+	std::size_t GetSize() const;
+};
+
+#endif
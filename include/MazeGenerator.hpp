@@ -0,0 +1,13 @@
+#ifndef MAZE_GENERATOR_HPP
+#define MAZE_GENERATOR_HPP
+
+#include <SDL2/SDL.h>
+
+#include <cstdint>
+
+// Builds a level image in the same colour scheme as res/levels: a random spanning-tree maze over
+// the odd cells with extra walls knocked out to add loops, pellets on every path and an energizer
+// near each corner. Width and height should be odd and at least 3; the caller frees the surface.
+SDL_Surface* GenerateMaze(int width, int height, std::uint32_t seed);
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <SDL2/SDL.h>
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+
+// Phases nest: TICK contains PLAYER, GHOSTS and COLLISION, one after another, RENDER contains
+// the rest except EVENTS.
+enum class Phase
+{
+	EVENTS, 
+	TICK, 
+	PLAYER, 
+	GHOSTS, 
+	COLLISION, 
+	RENDER, 
+	RENDER_BOARD, 
+	RENDER_ENTITIES, 
+	RENDER_INFO, 
+	PRESENT, 
+	COUNT
+};
+
+// Log-linear buckets in the spirit of HdrHistogram: values below 64 are exact, above that every
+// power of two is split into 32 buckets, so any recorded value is within ~3% of its bucket.
+class LatencyHistogram
+{
+private:
+	static constexpr int sub_bucket_bits = 5;
+	static constexpr int sub_bucket_count = 1 << sub_bucket_bits;
+	static constexpr int bucket_count = (64 - sub_bucket_bits + 1) * sub_bucket_count;
+
+	std::array<std::uint32_t, bucket_count> counts_;
+	std::uint64_t count_;
+	std::uint64_t max_;
+
+	static int GetBucket(std::uint64_t value);
+
+	static std::uint64_t GetBucketValue(int bucket);
+
+public:
+	LatencyHistogram();
+
+	void Record(std::uint64_t value)
+	{
+		++counts_[GetBucket(value)];
+		++count_;
+
+		if (value > max_)
+		{
+			max_ = value;
+		}
+	}
+
+	std::uint64_t GetPercentile(double percentile) const;
+
+	std::uint64_t GetCount() const;
+
+	std::uint64_t GetMax() const;
+
+	void Reset();
+};
+
+struct PhaseSummary
+{
+	std::uint64_t count;
+	double p50_ms;
+	double p99_ms;
+	double max_ms;
+};
+
+class Metrics
+{
+private:
+	static constexpr int phase_count = static_cast<int>(Phase::COUNT);
+
+	bool enabled_;
+	std::uint64_t frequency_;
+	std::uint64_t interval_start_;
+	std::uint64_t first_start_;
+	std::uint64_t generation_;
+
+	std::array<LatencyHistogram, phase_count> histograms_;
+	std::array<PhaseSummary, phase_count> summaries_;
+
+	FILE* file_;
+	bool json_;
+
+	void Summarise(std::uint64_t now);
+
+public:
+	Metrics();
+
+	~Metrics();
+
+	void SetEnabled(bool enabled);
+
+	bool IsEnabled() const
+	{
+		return enabled_;
+	}
+
+	// Whether --metrics has a file open, which keeps timing on whatever the overlay does.
+	bool IsOpen() const
+	{
+		return file_ != nullptr;
+	}
+
+	bool Open(const char* path);
+
+	void Close();
+
+	void Record(Phase phase, std::uint64_t counter_ticks)
+	{
+		histograms_[static_cast<int>(phase)].Record(counter_ticks);
+	}
+
+	void Update(bool force = false);
+
+	const PhaseSummary& GetSummary(Phase phase) const;
+
+	std::uint64_t GetGeneration() const;
+
+	static const char* GetPhaseName(Phase phase);
+};
+
+// Times the enclosing scope into a phase histogram; reads no clock at all while metrics are disabled.
+class ScopedPhase
+{
+private:
+	Metrics* metrics_;
+	Phase phase_;
+	std::uint64_t start_;
+
+public:
+	ScopedPhase(Metrics* metrics, Phase phase) : 
+		metrics_(metrics->IsEnabled() ? metrics : nullptr), 
+		phase_(phase), 
+		start_(metrics_ != nullptr ? SDL_GetPerformanceCounter() : 0)
+	{
+	}
+
+	~ScopedPhase()
+	{
+		if (metrics_ != nullptr)
+		{
+			metrics_->Record(phase_, SDL_GetPerformanceCounter() - start_);
+		}
+	}
+
+	ScopedPhase(const ScopedPhase&) = delete;
+
+	ScopedPhase& operator=(const ScopedPhase&) = delete;
+};
+
+#define METRICS_CONCAT_INNER(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_INNER(a, b)
+
+// Build with -DPACMAN_NO_METRICS (make METRICS=0) to compile every scope out.
+#ifdef PACMAN_NO_METRICS
+#define METRICS_SCOPE(metrics, phase)
+#else
+#define METRICS_SCOPE(metrics, phase) ScopedPhase METRICS_CONCAT(metrics_scope_, __LINE__)((metrics), (phase))
+#endif
+
+#endif
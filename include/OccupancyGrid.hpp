@@ -0,0 +1,74 @@
+#ifndef OCCUPANCY_GRID_HPP
+#define OCCUPANCY_GRID_HPP
+
+#include "Entity.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+enum class Occupant
+{
+	PLAYER, GHOST, COUNT
+};
+
+// How many entities of each kind stand on every tile, plus which tile edges they crossed during
+// the current logic step. Every query looks at a fixed set of tiles, so none of them grows with
+// the number of entities on the board.
+class OccupancyGrid
+{
+private:
+	// One byte per tile and Occupant. A tile crowded past crowded_count keeps crowded_count there
+	// and its real count in crowded_, so the grid costs a byte per tile and occupant.
+	static constexpr std::uint8_t crowded_count = 0xff;
+
+	std::vector<std::uint8_t> counts_;
+	std::unordered_map<std::size_t, int> crowded_;
+	// One bit per Occupant and Direction, set on the tile an entity stepped onto.
+	std::vector<std::uint8_t> crossings_;
+	std::vector<int> crossed_tiles_;
+	int width_;
+	int height_;
+
+public:
+	OccupancyGrid();
+
+	~OccupancyGrid();
+
+	void Resize(int width, int height);
+
+	void Clear();
+
+	// Forgets the edge crossings of the previous logic step.
+	void BeginStep();
+
+	void Add(Occupant occupant, int tile);
+
+	void Remove(Occupant occupant, int tile);
+
+	// Moves an occupant and, when direction is not NONE, records the edge it crossed to get there.
+	void Move(Occupant occupant, int from, int to, Direction direction);
+
+	int GetCount(Occupant occupant, int tile) const;
+
+	// Whether an occupant stepped onto tile this step while moving in direction.
+	bool HasEntered(Occupant occupant, int tile, Direction direction) const;
+
+	// Occupants at most distance tiles away from tile, measured like Level::TileDistance.
+	int CountWithin(Occupant occupant, int tile, int distance) const;
+};
+
+inline int OccupancyGrid::GetCount(Occupant occupant, int tile) const
+{
+	const std::size_t slot = static_cast<std::size_t>(tile) * static_cast<int>(Occupant::COUNT) + static_cast<int>(occupant);
+
+	return counts_[slot] != crowded_count ? counts_[slot] : crowded_.find(slot)->second;
+}
+
+inline bool OccupancyGrid::HasEntered(Occupant occupant, int tile, Direction direction) const
+{
+	return (crossings_[tile] >> (static_cast<int>(occupant) * 4 + static_cast<int>(direction))) & 1;
+}
+
+#endif
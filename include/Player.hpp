@@ -2,6 +2,7 @@
 #define PLAYER_HPP
 
 #include "Entity.hpp"
+#include "GameState.hpp"
 
 #include <SDL2/SDL.h>
 
@@ -29,9 +30,16 @@ public:
 
 	void EatEnergizer();
 
-	Tile* GetNextTileInDirection(Direction direction);
+	int GetNextTileInDirection(Direction direction);
 
 	void SetDirection(Direction next_direction);
+
+	// XOR of the Zobrist keys for the player's tile and directions.
+	std::uint64_t GetHashKey() const;
+
+	void Snapshot(PlayerState& state) const;
+
+	void Restore(const PlayerState& state);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include "InputScript.hpp"
+#include "MappedFile.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// File layout, little-endian:
+//   "PMRP", u16 version, u16 tick rate, u16 logic step ticks, u16 starting lives,
+//   u32 length in ticks, u64 level hash, u32 ghost count, u32 reserved, then one varint per input
+//   event holding (ticks since the previous event << 3) | code, where code 0-3 is a Direction and
+//   4 a reset.
+struct ReplayHeader
+{
+	std::uint16_t tick_rate;
+	std::uint16_t logic_step_ticks;
+	std::uint16_t starting_lives;
+	std::uint32_t length_ticks;
+	std::uint64_t level_hash;
+	std::uint32_t ghost_count;
+};
+
+class ReplayRecorder
+{
+private:
+	std::vector<std::uint8_t> events_;
+	int last_tick_;
+
+public:
+	ReplayRecorder();
+
+	~ReplayRecorder();
+
+	void Record(const InputEvent& event);
+
+	bool Save(const char* path, const ReplayHeader& header) const;
+};
+
+class ReplayReader
+{
+private:
+	MappedFile file_;
+	ReplayHeader header_;
+	const std::uint8_t* cursor_;
+	const std::uint8_t* end_;
+	InputEvent next_;
+	bool has_next_;
+
+	void Decode();
+
+public:
+	ReplayReader();
+
+	~ReplayReader();
+
+	bool Open(const char* path);
+
+	const ReplayHeader& GetHeader() const;
+
+	const InputEvent* Peek() const;
+
+	void Advance();
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef REWIND_HPP
+#define REWIND_HPP
+
+#include "GameState.hpp"
+#include "InputScript.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The last few seconds of play, for stepping back in time. Play is cut into segments of at most
+// keyframe_steps logic steps, each a GameState keyframe followed by one varint record per step:
+// the inputs applied, the tiles the player and ghosts moved to, the pellets eaten and any reset.
+// Seeking restores the keyframe before the target and simulates the segment's inputs forward, so
+// it never re-runs more than keyframe_steps steps. Segments are recycled oldest first, so memory
+// stops growing once the buffer has filled.
+class Rewind
+{
+private:
+	struct Segment
+	{
+		GameState keyframe;
+		std::vector<std::uint8_t> deltas;
+		int steps;
+	};
+
+	std::vector<Segment> segments_;
+	int first_;
+	int count_;
+	int keyframe_steps_;
+
+	// The deltas a seek is re-simulating, to check the new run writes the same ones.
+	std::vector<std::uint8_t> expected_;
+	bool desynced_;
+
+	Segment& GetCurrent();
+
+	void Write(std::uint64_t value, int tag);
+
+public:
+	// Keeps at least seconds of play, with a keyframe every keyframe_steps logic steps.
+	Rewind(int seconds, int keyframe_steps);
+
+	~Rewind();
+
+	void BeginSegment(const GameState& keyframe);
+
+	void RecordInput(const InputEvent& event);
+
+	void RecordPlayerTile(int tile);
+
+	void RecordGhostTile(int index, int tile);
+
+	void RecordPellet(int tile);
+
+	void RecordReset();
+
+	// Closes the current step's record; true when the segment is full and the caller should
+	// start the next one with BeginSegment.
+	bool EndStep();
+
+	// Drops everything after the last keyframe at or before tick and hands back that keyframe and
+	// the inputs recorded after it. False if tick is older than the oldest keyframe.
+	bool Truncate(int tick, GameState& keyframe, InputScript& inputs);
+
+	// After re-simulating from Truncate's keyframe: whether the new run wrote the same deltas.
+	bool FinishSeek();
+
+	int GetOldestTick() const;
+
+	std::size_t GetMemoryUsage() const;
+};
+
+#endif
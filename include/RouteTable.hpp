@@ -0,0 +1,44 @@
+#ifndef ROUTE_TABLE_HPP
+#define ROUTE_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Level;
+
+// Every walkable tile's four directions ranked towards every other tile under the ghost move rules.
+// A table depends only on the level's layout, so Get hands every game on the same level one
+// read-only copy instead of each building its own.
+class RouteTable
+{
+private:
+	std::vector<int> index_;
+	std::vector<int> proxy_;
+	std::vector<std::uint8_t> routes_;
+	int count_;
+
+public:
+	RouteTable();
+
+	~RouteTable();
+
+	// Fails, leaving the table empty, if the level has no walkable tiles or the table would take
+	// more than constants::max_route_table_bytes.
+	bool Build(Level* level);
+
+	// The table for level's layout, built on first use and shared from then on; null if Build fails.
+	static std::shared_ptr<const RouteTable> Get(Level* level);
+
+	// Packs the four directions out of source, best first, two bits each starting at the low bits.
+	std::uint8_t GetRoute(int source, int target) const;
+};
+
+// Rows are per target, so Build writes each target's row in one pass.
+inline std::uint8_t RouteTable::GetRoute(int source, int target) const
+{
+	return routes_[static_cast<std::size_t>(proxy_[target]) * count_ + index_[source]];
+}
+
+#endif
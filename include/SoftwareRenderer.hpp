@@ -0,0 +1,93 @@
+#ifndef SOFTWARE_RENDERER_HPP
+#define SOFTWARE_RENDERER_HPP
+
+#include "DrawBuffer.hpp"
+#include "GlyphAtlas.hpp"
+#include "ThreadPool.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class FrameFormat
+{
+	RGBA, INDEXED
+};
+
+// Draws frames on the CPU into memory the caller owns, for capturing frames without an
+// SDL_Renderer. A frame is the window's layout scaled by scale, sampled at pixel centres the way
+// SDL scales without filtering. RGBA frames hold four bytes per pixel in R, G, B, A order. INDEXED
+// frames hold one byte per pixel indexing GetPalette(): colours get an index the first time they
+// are drawn and keep it, black being 0, and text is drawn where it covers at least half a pixel.
+//
+// Work is recorded with DrawRects and DrawText and drawn in order by Flush, which splits the rows
+// between the pool's threads.
+class SoftwareRenderer
+{
+private:
+	struct Operation
+	{
+		// Output pixels, clipped to the frame and the viewport.
+		int x0;
+		int y0;
+		int x1;
+		int y1;
+		std::uint32_t color;
+		std::uint8_t index;
+
+		// Text only: the atlas texel under each pixel is u0 + x * du, v0 + y * dv, kept within source.
+		const GlyphAtlas* atlas;
+		SDL_Rect source;
+		float u0;
+		float du;
+		float v0;
+		float dv;
+	};
+
+	std::vector<Operation> operations_;
+	std::vector<DrawCommand> commands_;
+	std::vector<SDL_Color> palette_;
+	ThreadPool* pool_;
+	float scale_;
+	FrameFormat format_;
+	int width_;
+	int height_;
+
+	int ScaleEdge(int edge) const;
+
+	bool Place(const SDL_Rect& destination, const SDL_Rect& viewport, Operation& operation) const;
+
+	void SetColor(const SDL_Color& color, Operation& operation);
+
+	void DrawRows(std::uint8_t* pixels, int first_row, int last_row) const;
+
+public:
+	// pool may be null to draw on the calling thread; Flush waits for the whole pool.
+	SoftwareRenderer(float scale, FrameFormat format, ThreadPool* pool = nullptr);
+
+	~SoftwareRenderer();
+
+	// Takes draw_buffer's rectangle fills, recorded relative to viewport, in the order
+	// DrawBuffer::Flush draws them, and empties the buffer. Texture copies are dropped; text goes
+	// through DrawText.
+	void DrawRects(DrawBuffer* draw_buffer, const SDL_Rect& viewport);
+
+	void DrawText(const GlyphAtlas& atlas, const TextLayout& layout, const SDL_Rect& viewport, int x, int y, const SDL_Color& color);
+
+	// Clears pixels, GetFrameSize() bytes, to black and draws everything recorded since the last Flush.
+	void Flush(std::uint8_t* pixels);
+
+	int GetWidth() const;
+
+	int GetHeight() const;
+
+	std::size_t GetFrameSize() const;
+
+	FrameFormat GetFormat() const;
+
+	const std::vector<SDL_Color>& GetPalette() const;
+};
+
+#endif
@@ -21,6 +21,10 @@ public:
 	
 	bool LoadFromText(SDL_Renderer* renderer, TTF_Font* font, const char* text, const SDL_Color& text_color, int text_length = -1);
 
+	bool LoadFromSurface(SDL_Renderer* renderer, SDL_Surface* surface);
+
+	bool CreateTarget(SDL_Renderer* renderer, int width, int height);
+
 	void Render(SDL_Renderer* renderer, int x, int y, float scale = 1.0, SDL_Rect* clip = nullptr);
 };
 
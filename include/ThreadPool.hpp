@@ -0,0 +1,67 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct WorkerStats
+{
+	double busy_seconds;
+	std::uint64_t tasks;
+	std::uint64_t steals;
+};
+
+class ThreadPool
+{
+private:
+	struct Worker
+	{
+		std::mutex mutex_;
+		std::deque<std::function<void()>> tasks_;
+		std::atomic<std::uint64_t> busy_ns_;
+		std::atomic<std::uint64_t> executed_;
+		std::atomic<std::uint64_t> stolen_;
+	};
+
+	std::vector<std::unique_ptr<Worker>> workers_;
+	std::vector<std::thread> threads_;
+
+	std::mutex wait_mutex_;
+	std::condition_variable work_available_;
+	std::condition_variable work_done_;
+
+	std::atomic<std::int64_t> queued_;
+	std::atomic<std::int64_t> pending_;
+	std::atomic<bool> stopping_;
+	std::atomic<std::uint64_t> next_worker_;
+
+	void WorkerLoop(int index);
+
+	bool PopLocal(int index, std::function<void()>& task);
+
+	bool Steal(int index, std::function<void()>& task);
+
+public:
+	explicit ThreadPool(int thread_count);
+
+	~ThreadPool();
+
+	void Submit(std::function<void()> task);
+
+	void Wait();
+
+	int GetThreadCount() const;
+
+	WorkerStats GetWorkerStats(int index) const;
+
+	void ResetStats();
+};
+
+#endif
@@ -1,39 +1,12 @@
 #ifndef TILE_HPP
 #define TILE_HPP
 
-#include <SDL2/SDL.h>
+#include <cstdint>
 
-enum class TileType
+// Tiles are stored by Level as one byte each; position and size follow from the tile's index.
+enum class TileType : std::uint8_t
 {
 	EMPTY, WALL, PATH, GHOST_GATE, GHOST_HOME, GHOST_CROSSROAD
 };
 
-class Game;
-
-class Tile
-{
-private:
-	Game* game_;
-
-public:
-	TileType type_;
-	SDL_Rect rect_;
-	int tile_size_;
-
-	bool pellet_;
-	bool pellet_spawned_;
-	bool energizer_;
-	bool energizer_spawned_;
-
-	Tile(Game* game);
-
-	~Tile();
-
-	void Tick();
-
-	void Render() const;
-
-	bool IsWall() const;
-};
-
-#endif
\ No newline at end of file
+#endif
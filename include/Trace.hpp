@@ -0,0 +1,134 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <SDL2/SDL.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct TraceEvent
+{
+	const char* name;
+	std::uint64_t begin;
+	std::uint64_t end;
+};
+
+// Ring of completed zones owned by a single thread. Only that thread writes; the newest events
+// overwrite the oldest once it wraps, and the reader publishes nothing back.
+class TraceBuffer
+{
+private:
+	std::vector<TraceEvent> events_;
+	std::uint64_t mask_;
+	std::atomic<std::uint64_t> written_;
+	std::string thread_name_;
+	int thread_id_;
+
+public:
+	TraceBuffer(int thread_id, std::size_t capacity);
+
+	void Push(const TraceEvent& event)
+	{
+		const std::uint64_t index = written_.load(std::memory_order_relaxed);
+		events_[index & mask_] = event;
+		written_.store(index + 1, std::memory_order_release);
+	}
+
+	void SetThreadName(const char* name);
+
+	const std::string& GetThreadName() const;
+
+	int GetThreadId() const;
+
+	std::uint64_t GetWritten() const;
+
+	std::uint64_t GetCapacity() const;
+
+	const TraceEvent& GetEvent(std::uint64_t index) const;
+};
+
+// Collects zones from every thread and writes them out as Chrome Trace Event JSON, which loads in
+// chrome://tracing and Perfetto.
+class Trace
+{
+private:
+	static std::atomic<bool> enabled_;
+	static std::mutex buffers_mutex_;
+	static std::vector<std::unique_ptr<TraceBuffer>> buffers_;
+	static std::string path_;
+	static std::uint64_t start_;
+
+	static TraceBuffer* GetThreadBuffer();
+
+public:
+	static bool IsEnabled()
+	{
+		return enabled_.load(std::memory_order_relaxed);
+	}
+
+	static void Start(const char* path);
+
+	// Writes the file; instrumented threads other than the caller must be idle by now.
+	static bool Stop();
+
+	static void SetThreadName(const char* name);
+
+	static void Record(const char* name, std::uint64_t begin, std::uint64_t end)
+	{
+		GetThreadBuffer()->Push({ name, begin, end });
+	}
+};
+
+class TraceZone
+{
+private:
+	const char* name_;
+	std::uint64_t begin_;
+
+public:
+	explicit TraceZone(const char* name) : 
+		name_(Trace::IsEnabled() ? name : nullptr), 
+		begin_(name_ != nullptr ? SDL_GetPerformanceCounter() : 0)
+	{
+	}
+
+	~TraceZone()
+	{
+		if (name_ != nullptr)
+		{
+			Trace::Record(name_, begin_, SDL_GetPerformanceCounter());
+		}
+	}
+
+	TraceZone(const TraceZone&) = delete;
+
+	TraceZone& operator=(const TraceZone&) = delete;
+};
+
+// Starts tracing to a file for the lifetime of the object when given a path.
+class TraceSession
+{
+private:
+	bool active_;
+
+public:
+	explicit TraceSession(const char* path);
+
+	~TraceSession();
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// Build with -DPACMAN_NO_TRACE (make TRACE=0) to compile every zone out.
+#ifdef PACMAN_NO_TRACE
+#define TRACE_ZONE(name)
+#else
+#define TRACE_ZONE(name) TraceZone TRACE_CONCAT(trace_zone_, __LINE__)(name)
+#endif
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef TRANSPOSITION_TABLE_HPP
+#define TRANSPOSITION_TABLE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+enum class Bound : std::uint8_t
+{
+	NONE, EXACT, LOWER, UPPER
+};
+
+// What a search learned about one state, packed into 64 bits.
+struct TranspositionEntry
+{
+	std::int32_t value;
+	std::uint16_t depth;
+	Bound bound;
+	std::uint8_t move;
+};
+
+// A fixed-size table from game state hashes to search results that any number of threads can
+// probe and store into at once without locks. Each slot holds the entry and the hash XORed with
+// it; a probe that catches two stores half-written sees a hash that does not match and misses.
+class TranspositionTable
+{
+private:
+	struct Slot
+	{
+		std::atomic<std::uint64_t> check_;
+		std::atomic<std::uint64_t> data_;
+	};
+
+	std::unique_ptr<Slot[]> slots_;
+	std::size_t mask_;
+
+public:
+	// entry_count is rounded up to a power of two.
+	explicit TranspositionTable(std::size_t entry_count);
+
+	~TranspositionTable();
+
+	void Clear();
+
+	// Keeps the deeper result when the slot already holds the same state, otherwise replaces it.
+	void Store(std::uint64_t hash, const TranspositionEntry& entry);
+
+	bool Probe(std::uint64_t hash, TranspositionEntry& entry) const;
+
+	std::size_t GetSize() const;
+};
+
+#endif
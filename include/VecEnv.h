@@ -0,0 +1,38 @@
+#ifndef VEC_ENV_H
+#define VEC_ENV_H
+
+/*
+ * C interface to VecEnv, for training code outside C++ (for example through Python's ctypes).
+ * Actions are one byte per environment: 0 left, 1 right, 2 up, 3 down, 4 keep going. Every
+ * observation buffer holds vec_env_observation_size() bytes per environment, back to back.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct VecEnvHandle VecEnvHandle;
+
+/* level_path may be NULL for the default maze. Returns NULL if the environments cannot be set up. */
+VecEnvHandle* vec_env_create(int env_count, int thread_count, const char* level_path);
+
+void vec_env_destroy(VecEnvHandle* env);
+
+int vec_env_count(const VecEnvHandle* env);
+
+int vec_env_observation_size(const VecEnvHandle* env);
+
+/* Observation planes are plane_count x height x width bytes. */
+void vec_env_observation_shape(const VecEnvHandle* env, int* plane_count, int* height, int* width);
+
+void vec_env_reset(VecEnvHandle* env, uint8_t* observations);
+
+void vec_env_step(VecEnvHandle* env, const uint8_t* actions, uint8_t* observations, float* rewards, uint8_t* dones);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef VEC_ENV_HPP
+#define VEC_ENV_HPP
+
+#include "GameState.hpp"
+#include "ThreadPool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Game;
+
+enum class ObservationPlane
+{
+	WALLS, PELLETS, ENERGIZERS, PLAYER, GHOSTS
+};
+
+// A batch of environments stepped together for reinforcement learning. Each environment is a
+// GameState; the thread pool's workers each step a shard of them through a headless Game of their
+// own with Game::Step, so one environment costs a few hundred bytes.
+//
+// A step is one logic step. The reward is the score gained. An environment whose game ends (game
+// over or level completed) reports done and is reset on the spot, the way Game::Reset would, so
+// the observation returned with done is already the start of the next episode.
+//
+// Observations are written straight into the caller's buffer, one environment after another, as
+// uint8 planes over the tile grid holding 1 where the plane's feature is and 0 elsewhere: walls,
+// pellets, energizers, the player, then one plane per ghost.
+class VecEnv
+{
+private:
+	std::vector<GameState> states_;
+	GameState initial_;
+	std::vector<std::unique_ptr<Game>> games_;
+	std::vector<std::uint8_t> walls_;
+	ThreadPool pool_;
+	int width_;
+	int height_;
+	int ghost_count_;
+
+	void StepShard(int shard, const std::uint8_t* actions, std::uint8_t* observations, float* rewards, std::uint8_t* dones);
+
+	void WriteObservation(const GameState& state, std::uint8_t* observation) const;
+
+public:
+	VecEnv(int env_count, int thread_count);
+
+	~VecEnv();
+
+	// level_path may be null for the default maze. Fails if the level cannot be loaded or is too
+	// big for a GameState.
+	bool Initialize(const char* level_path = nullptr);
+
+	// Starts every environment on a fresh game.
+	void Reset(std::uint8_t* observations);
+
+	// actions holds one Direction per environment, NONE (4) to keep going; any other value counts as NONE.
+	void Step(const std::uint8_t* actions, std::uint8_t* observations, float* rewards, std::uint8_t* dones);
+
+	int GetEnvCount() const;
+
+	int GetPlaneCount() const;
+
+	int GetWidth() const;
+
+	int GetHeight() const;
+
+	std::size_t GetObservationSize() const;
+};
+
+#endif
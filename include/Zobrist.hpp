@@ -0,0 +1,34 @@
+#ifndef ZOBRIST_HPP
+#define ZOBRIST_HPP
+
+#include <cstdint>
+
+// Zobrist keys for the parts of a game that change during play. A game's hash is the XOR of the
+// keys of every feature it currently has, so moving a piece of state is two XORs.
+namespace zobrist
+{
+	enum class Feature : std::uint64_t
+	{
+		PELLET, ENERGIZER, PLAYER_TILE, PLAYER_DIRECTION, PLAYER_QUEUED_DIRECTION, GHOST_TILE, GHOST_DIRECTION, GHOST_MODE, MODE_TICKS
+	};
+
+	// The splitmix64 output at position index of a fixed stream, worked out on demand so boards of
+	// any size need no key tables.
+	inline std::uint64_t Key(std::uint64_t index)
+	{
+		std::uint64_t z = 0x5041434d414e5a42ull + (index + 1) * 0x9e3779b97f4a7c15ull;
+
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+
+		return z ^ (z >> 31);
+	}
+
+	// owner tells ghosts apart; value is a tile, direction, mode or timer.
+	inline std::uint64_t Key(Feature feature, std::uint32_t owner, std::uint32_t value)
+	{
+		return Key((static_cast<std::uint64_t>(feature) << 60) ^ (static_cast<std::uint64_t>(owner) << 32) ^ value);
+	}
+}
+
+#endif
@@ -0,0 +1,110 @@
+#include "BatchRunner.hpp"
+#include "Game.hpp"
+#include "Trace.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <cstdio>
+#include <memory>
+#include <random>
+
+BatchRunner::BatchRunner(int thread_count) : pool_(thread_count), last_run_seconds_(0.0), last_run_games_(0)
+{
+}
+
+BatchRunner::~BatchRunner()
+{
+}
+
+std::vector<BatchResult> BatchRunner::Run(const std::vector<BatchJob>& jobs)
+{
+	std::vector<BatchResult> results(jobs.size());
+
+	pool_.ResetStats();
+	const std::uint64_t start = SDL_GetPerformanceCounter();
+
+	for (std::size_t i = 0; i < jobs.size(); ++i)
+	{
+		pool_.Submit([&jobs, &results, i]()
+		{
+			TRACE_ZONE("BatchRunner::Job");
+
+			const BatchJob& job = jobs[i];
+			const std::unique_ptr<Game> game = std::make_unique<Game>(true);
+
+			BatchResult& result = results[i];
+			result.job = i;
+			result.seed = job.seed;
+
+			result.loaded = true;
+
+			if (!job.level_path.empty() && !game->LoadLevel(job.level_path.c_str()))
+			{
+				result.resets = 0;
+				result.loaded = false;
+			}
+			else if (job.replay_path.empty())
+			{
+				game->SetGhostCount(job.ghost_count);
+				result.resets = game->Simulate(job.ticks, job.script);
+			}
+			else if (game->LoadReplay(job.replay_path.c_str()))
+			{
+				result.resets = game->Simulate(game->GetReplayLength(), {}, false);
+			}
+			else
+			{
+				result.resets = 0;
+				result.loaded = false;
+			}
+
+			result.score = game->score_;
+			result.lives = game->lives_;
+			result.levels_cleared = game->levels_cleared_;
+			result.game_ticks = game->game_ticks_;
+			result.hash_matches = !result.loaded || game->GetStateHash() == game->ComputeStateHash();
+		});
+	}
+
+	pool_.Wait();
+
+	const std::uint64_t end = SDL_GetPerformanceCounter();
+	last_run_seconds_ = static_cast<double>(end - start) / static_cast<double>(SDL_GetPerformanceFrequency());
+	last_run_games_ = jobs.size();
+
+	return results;
+}
+
+void BatchRunner::PrintReport()
+{
+	printf("Simulated %zu games on %d workers in %.3f s\n", last_run_games_, pool_.GetThreadCount(), last_run_seconds_);
+
+	if (last_run_seconds_ > 0.0)
+	{
+		printf("Games/s: %.1f\n", last_run_games_ / last_run_seconds_);
+	}
+
+	for (int i = 0; i < pool_.GetThreadCount(); ++i)
+	{
+		const WorkerStats stats = pool_.GetWorkerStats(i);
+		const double utilisation = last_run_seconds_ > 0.0 ? 100.0 * stats.busy_seconds / last_run_seconds_ : 0.0;
+
+		printf("Worker %d: %5.1f%% busy, %llu games, %llu stolen\n", i, utilisation, static_cast<unsigned long long>(stats.tasks), static_cast<unsigned long long>(stats.steals));
+	}
+}
+
+InputScript BatchRunner::MakeRandomScript(std::uint32_t seed, int ticks)
+{
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> gap(10, 60);
+	std::uniform_int_distribution<int> direction(0, 3);
+
+	InputScript script;
+
+	for (int tick = gap(rng); tick < ticks; tick += gap(rng))
+	{
+		script.push_back({ tick, InputType::DIRECTION, static_cast<Direction>(direction(rng)) });
+	}
+
+	return script;
+}
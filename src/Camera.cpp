@@ -0,0 +1,55 @@
+#include "Camera.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+
+Camera::Camera() : view_{ 0, 0, 0, 0 }
+{
+}
+
+Camera::~Camera()
+{
+}
+
+void Camera::SetSize(int width, int height)
+{
+	view_.w = width;
+	view_.h = height;
+}
+
+void Camera::Follow(const SDL_Rect& target, int board_width, int board_height)
+{
+	const auto place = [](int center, int view_size, int board_size)
+	{
+		if (board_size <= view_size)
+		{
+			return (board_size - view_size) / 2;
+		}
+
+		return std::clamp(center - view_size / 2, 0, board_size - view_size);
+	};
+
+	view_.x = place(target.x + target.w / 2, view_.w, board_width);
+	view_.y = place(target.y + target.h / 2, view_.h, board_height);
+}
+
+const SDL_Rect& Camera::GetView() const
+{
+	return view_;
+}
+
+bool Camera::IsVisible(const SDL_Rect& rect) const
+{
+	return rect.x < view_.x + view_.w && rect.x + rect.w > view_.x && rect.y < view_.y + view_.h && rect.y + rect.h > view_.y;
+}
+
+SDL_Rect Camera::GetVisibleTiles(int tile_size, int columns, int rows) const
+{
+	const int first_column = std::max(view_.x, 0) / tile_size;
+	const int first_row = std::max(view_.y, 0) / tile_size;
+	const int last_column = std::min((view_.x + view_.w + tile_size - 1) / tile_size, columns);
+	const int last_row = std::min((view_.y + view_.h + tile_size - 1) / tile_size, rows);
+
+	return { first_column, first_row, std::max(last_column - first_column, 0), std::max(last_row - first_row, 0) };
+}
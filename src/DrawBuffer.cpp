@@ -0,0 +1,217 @@
+#include "DrawBuffer.hpp"
+#include "Trace.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace
+{
+	std::uint32_t PackColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+	{
+		return (static_cast<std::uint32_t>(r) << 24) | (static_cast<std::uint32_t>(g) << 16) | (static_cast<std::uint32_t>(b) << 8) | a;
+	}
+
+	bool SameState(const DrawCommand& lhs, const DrawCommand& rhs)
+	{
+		return lhs.layer == rhs.layer && lhs.texture == rhs.texture && lhs.color == rhs.color;
+	}
+}
+
+DrawBuffer::DrawBuffer() : frame_stats_{ 0, 0, 0 }, last_frame_stats_{ 0, 0, 0 }, origin_x_(0), origin_y_(0)
+{
+}
+
+DrawBuffer::~DrawBuffer()
+{
+}
+
+void DrawBuffer::BeginFrame()
+{
+	last_frame_stats_ = frame_stats_;
+	frame_stats_ = { 0, 0, 0 };
+}
+
+void DrawBuffer::SetOrigin(int x, int y)
+{
+	origin_x_ = x;
+	origin_y_ = y;
+}
+
+void DrawBuffer::FillRect(DrawLayer layer, const SDL_Rect& rect, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	const SDL_Rect destination = { rect.x - origin_x_, rect.y - origin_y_, rect.w, rect.h };
+	commands_.push_back({ layer, nullptr, PackColor(r, g, b, a), { 0, 0, 0, 0 }, destination, true });
+}
+
+void DrawBuffer::CopyTexture(DrawLayer layer, SDL_Texture* texture, const SDL_Rect* source, const SDL_Rect& destination, const SDL_Color& color)
+{
+	if (texture == nullptr)
+	{
+		return;
+	}
+
+	// Texture commands use the colour as a modulation, so tinted text batches per tint.
+	commands_.push_back({ layer, texture, PackColor(color.r, color.g, color.b, color.a), source != nullptr ? *source : SDL_Rect{ 0, 0, 0, 0 }, SDL_Rect{ destination.x - origin_x_, destination.y - origin_y_, destination.w, destination.h }, source == nullptr });
+}
+
+void DrawBuffer::Flush(SDL_Renderer* renderer)
+{
+	TRACE_ZONE("DrawBuffer::Flush");
+
+	frame_stats_.commands += static_cast<int>(commands_.size());
+
+	std::stable_sort(commands_.begin(), commands_.end(), DrawsBefore);
+
+	bool color_set = false;
+	std::uint32_t current_color = 0;
+
+	for (std::size_t begin = 0; begin < commands_.size();)
+	{
+		std::size_t end = begin + 1;
+
+		while (end < commands_.size() && SameState(commands_[begin], commands_[end]))
+		{
+			++end;
+		}
+
+		if (commands_[begin].texture == nullptr)
+		{
+			const std::uint32_t color = commands_[begin].color;
+
+			if (!color_set || color != current_color)
+			{
+				SDL_SetRenderDrawColor(renderer, color >> 24, (color >> 16) & 0xff, (color >> 8) & 0xff, color & 0xff);
+				++frame_stats_.state_changes;
+				current_color = color;
+				color_set = true;
+			}
+
+			FlushRects(renderer, begin, end);
+		}
+		else
+		{
+			++frame_stats_.state_changes;
+			FlushTextures(renderer, begin, end);
+		}
+
+		begin = end;
+	}
+
+	commands_.clear();
+}
+
+void DrawBuffer::TakeCommands(std::vector<DrawCommand>& commands)
+{
+	frame_stats_.commands += static_cast<int>(commands_.size());
+
+	commands.clear();
+	commands.swap(commands_);
+}
+
+bool DrawBuffer::DrawsBefore(const DrawCommand& lhs, const DrawCommand& rhs)
+{
+	if (lhs.layer != rhs.layer)
+	{
+		return lhs.layer < rhs.layer;
+	}
+
+	if (lhs.layer != DrawLayer::MAZE && lhs.layer != DrawLayer::PELLETS && lhs.layer != DrawLayer::HUD)
+	{
+		return false;
+	}
+
+	if (lhs.texture != rhs.texture)
+	{
+		return reinterpret_cast<std::uintptr_t>(lhs.texture) < reinterpret_cast<std::uintptr_t>(rhs.texture);
+	}
+
+	return lhs.color < rhs.color;
+}
+
+const DrawStats& DrawBuffer::GetFrameStats() const
+{
+	return frame_stats_;
+}
+
+const DrawStats& DrawBuffer::GetLastFrameStats() const
+{
+	return last_frame_stats_;
+}
+
+void DrawBuffer::FlushRects(SDL_Renderer* renderer, std::size_t begin, std::size_t end)
+{
+	rects_.clear();
+
+	for (std::size_t i = begin; i < end; ++i)
+	{
+		rects_.push_back(commands_[i].destination);
+	}
+
+	SDL_RenderFillRects(renderer, rects_.data(), static_cast<int>(rects_.size()));
+	++frame_stats_.draw_calls;
+}
+
+void DrawBuffer::FlushTextures(SDL_Renderer* renderer, std::size_t begin, std::size_t end)
+{
+	SDL_Texture* texture = commands_[begin].texture;
+	const std::uint32_t color = commands_[begin].color;
+	const SDL_Color modulation = { static_cast<Uint8>(color >> 24), static_cast<Uint8>((color >> 16) & 0xff), static_cast<Uint8>((color >> 8) & 0xff), static_cast<Uint8>(color & 0xff) };
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	if (end - begin > 1)
+	{
+		int width = 0;
+		int height = 0;
+		SDL_QueryTexture(texture, nullptr, nullptr, &width, &height);
+
+		vertices_.clear();
+		indices_.clear();
+
+		// Vertex colours carry the tint here; clear any modulation a RenderCopy run left behind.
+		SDL_SetTextureColorMod(texture, 0xff, 0xff, 0xff);
+		SDL_SetTextureAlphaMod(texture, 0xff);
+
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			const DrawCommand& command = commands_[i];
+			const SDL_Rect source = command.full_source ? SDL_Rect{ 0, 0, width, height } : command.source;
+			const SDL_Rect& destination = command.destination;
+
+			const float u0 = static_cast<float>(source.x) / width;
+			const float v0 = static_cast<float>(source.y) / height;
+			const float u1 = static_cast<float>(source.x + source.w) / width;
+			const float v1 = static_cast<float>(source.y + source.h) / height;
+
+			const float x0 = static_cast<float>(destination.x);
+			const float y0 = static_cast<float>(destination.y);
+			const float x1 = static_cast<float>(destination.x + destination.w);
+			const float y1 = static_cast<float>(destination.y + destination.h);
+
+			const int first = static_cast<int>(vertices_.size());
+
+			vertices_.push_back({ { x0, y0 }, modulation, { u0, v0 } });
+			vertices_.push_back({ { x1, y0 }, modulation, { u1, v0 } });
+			vertices_.push_back({ { x1, y1 }, modulation, { u1, v1 } });
+			vertices_.push_back({ { x0, y1 }, modulation, { u0, v1 } });
+
+			indices_.insert(indices_.end(), { first, first + 1, first + 2, first, first + 2, first + 3 });
+		}
+
+		SDL_RenderGeometry(renderer, texture, vertices_.data(), static_cast<int>(vertices_.size()), indices_.data(), static_cast<int>(indices_.size()));
+		++frame_stats_.draw_calls;
+		return;
+	}
+#endif
+
+	SDL_SetTextureColorMod(texture, modulation.r, modulation.g, modulation.b);
+	SDL_SetTextureAlphaMod(texture, modulation.a);
+
+	for (std::size_t i = begin; i < end; ++i)
+	{
+		const DrawCommand& command = commands_[i];
+		SDL_RenderCopy(renderer, texture, command.full_source ? nullptr : &command.source, &command.destination);
+		++frame_stats_.draw_calls;
+	}
+}
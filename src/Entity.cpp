@@ -2,9 +2,7 @@
 #include "Game.hpp"
 #include "Level.hpp"
 
-#include <vector>
-
-Entity::Entity(Game* game) : game_(game), level_(nullptr), direction_(Direction::LEFT), current_tile_(nullptr)
+Entity::Entity(Game* game) : game_(game), level_(nullptr), direction_(Direction::LEFT), current_tile_(-1)
 {
 }
 
@@ -17,32 +15,30 @@ void Entity::SetLevel(Level* level)
 	level_ = level;
 }
 
-Tile* Entity::GetCurrentTile()
+int Entity::GetCurrentTile()
 {
 	return current_tile_;
 }
 
 void Entity::DebugNeighbors()
 {
-	const std::vector<Tile*> neighbors = level_->GetNeighborTiles(current_tile_->rect_.x, current_tile_->rect_.y);
+	const std::array<int, 4> neighbors = level_->GetNeighbors(current_tile_);
 
-	for (std::size_t i = 0; i < neighbors.size(); ++i)
+	for (int i = 0; i < 4; ++i)
 	{
-		if (neighbors[i] == nullptr)
+		if (neighbors[i] == -1)
 		{
 			continue;
 		}
 
-		if (neighbors[i]->IsWall())
+		if (level_->IsWall(neighbors[i]))
 		{
-			SDL_SetRenderDrawColor(game_->renderer_, 0xff, 0x00, 0x00, 0xff);
+			game_->GetDrawBuffer()->FillRect(DrawLayer::DEBUG, level_->GetTileRect(neighbors[i]), 0xff, 0x00, 0x00);
 		}
 		else
 		{
-			SDL_SetRenderDrawColor(game_->renderer_, 0x00, 0xff, 0x00, 0xff);
+			game_->GetDrawBuffer()->FillRect(DrawLayer::DEBUG, level_->GetTileRect(neighbors[i]), 0x00, 0xff, 0x00);
 		}
-
-		SDL_RenderFillRect(game_->renderer_, &neighbors[i]->rect_);
 	}
 }
 
@@ -0,0 +1,64 @@
+#include "FlowField.hpp"
+#include "Level.hpp"
+#include "Trace.hpp"
+
+FlowField::FlowField() : target_(-1)
+{
+}
+
+FlowField::~FlowField()
+{
+}
+
+void FlowField::Update(Level* level, int target)
+{
+	if (target == target_)
+	{
+		return;
+	}
+
+	TRACE_ZONE("FlowField::Update");
+
+	target_ = target;
+	distance_.assign(level->GetTileCount(), unreachable);
+	queue_.clear();
+
+	if (target < 0)
+	{
+		return;
+	}
+
+	distance_[target] = 0;
+	queue_.push_back(target);
+
+	// Walk the ghost move rules backwards from the target, as the route table does for every tile.
+	for (std::size_t head = 0; head < queue_.size(); ++head)
+	{
+		const int tile = queue_[head];
+
+		for (int i = 0; i < 4; ++i)
+		{
+			const Direction direction = static_cast<Direction>(i);
+			const int source = level->GetNeighbor(tile, static_cast<Direction>(i ^ 1));
+
+			if (source == -1 || distance_[source] != unreachable)
+			{
+				continue;
+			}
+
+			if (level->GetNeighbor(source, direction) != tile || !level->CanGhostStep(source, direction))
+			{
+				continue;
+			}
+
+			distance_[source] = distance_[tile] + 1;
+			queue_.push_back(source);
+		}
+	}
+}
+
+void FlowField::Clear()
+{
+	target_ = -1;
+	distance_.clear();
+}
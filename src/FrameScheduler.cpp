@@ -0,0 +1,161 @@
+#include "FrameScheduler.hpp"
+#include "Constants.hpp"
+#include "Trace.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+FrameScheduler::FrameScheduler() : 
+	mode_(FrameMode::VSYNC), 
+	target_fps_(constants::tick_rate), 
+	frequency_(SDL_GetPerformanceFrequency()), 
+	frame_period_(0), 
+	sleep_margin_(0), 
+	last_time_(0), 
+	frame_start_(0), 
+	next_deadline_(0), 
+	cpu_start_(0), 
+	accumulator_(0.0), 
+	stats_{ 0, 0, 0, 0.0, 0.0, 0.0 }
+{
+	SetMode(mode_, target_fps_);
+}
+
+void FrameScheduler::SetMode(FrameMode mode, double target_fps)
+{
+	mode_ = mode;
+	target_fps_ = target_fps > 0.0 ? target_fps : constants::tick_rate;
+	frame_period_ = static_cast<std::uint64_t>(static_cast<double>(frequency_) / target_fps_);
+
+	// Start by assuming the OS oversleeps by up to 2 ms; Pace() adapts this to the measured overshoot.
+	sleep_margin_ = frequency_ / 500;
+
+	Resync();
+}
+
+FrameMode FrameScheduler::GetMode()
+{
+	return mode_;
+}
+
+double FrameScheduler::GetTargetFps()
+{
+	return target_fps_;
+}
+
+void FrameScheduler::Resync()
+{
+	last_time_ = SDL_GetPerformanceCounter();
+	next_deadline_ = last_time_ + frame_period_;
+	accumulator_ = 0.0;
+}
+
+void FrameScheduler::BeginFrame(bool idle)
+{
+	frame_start_ = SDL_GetPerformanceCounter();
+	cpu_start_ = std::clock();
+
+	if (idle)
+	{
+		++stats_.idle_frames;
+	}
+}
+
+int FrameScheduler::TicksDue(double speed)
+{
+	const std::uint64_t now = SDL_GetPerformanceCounter();
+	long double elapsed = static_cast<long double>(now - last_time_) / static_cast<long double>(frequency_);
+
+	last_time_ = now;
+
+	// Bounded catch-up: after a stall (debugger, window drag, slow frame) drop the excess instead of
+	// simulating it, otherwise a frame that runs too many ticks makes the next frame late as well.
+	if (elapsed > constants::max_catch_up_seconds)
+	{
+		stats_.dropped_ticks += static_cast<std::uint64_t>((elapsed - constants::max_catch_up_seconds) * speed * constants::tick_rate);
+		elapsed = constants::max_catch_up_seconds;
+	}
+
+	accumulator_ += elapsed * speed * constants::tick_rate;
+
+	const int ticks = static_cast<int>(accumulator_);
+	accumulator_ -= ticks;
+
+	return ticks;
+}
+
+void FrameScheduler::EndFrame()
+{
+	if (mode_ == FrameMode::CAPPED)
+	{
+		Pace();
+	}
+
+	const std::uint64_t now = SDL_GetPerformanceCounter();
+	const double cpu_seconds = static_cast<double>(std::clock() - cpu_start_) / CLOCKS_PER_SEC;
+
+	++stats_.frames;
+	stats_.wall_seconds += static_cast<double>(now - frame_start_) / static_cast<double>(frequency_);
+	stats_.cpu_seconds += cpu_seconds;
+	stats_.max_cpu_seconds = std::max(stats_.max_cpu_seconds, cpu_seconds);
+}
+
+void FrameScheduler::Pace()
+{
+	TRACE_ZONE("FrameScheduler::Pace");
+
+	std::uint64_t now = SDL_GetPerformanceCounter();
+
+	// More than a whole frame late: start a fresh schedule rather than rushing out frames to catch up.
+	if (now > next_deadline_ + frame_period_)
+	{
+		next_deadline_ = now + frame_period_;
+		return;
+	}
+
+	if (now + sleep_margin_ < next_deadline_)
+	{
+		const std::uint64_t request = next_deadline_ - sleep_margin_ - now;
+		const std::uint64_t before = now;
+
+		std::this_thread::sleep_for(std::chrono::nanoseconds(request * 1000000000ull / frequency_));
+
+		now = SDL_GetPerformanceCounter();
+
+		// Track how far the OS oversleeps: grow the margin quickly, shrink it slowly, and never let one
+		// outlier turn most of the frame into spinning.
+		const std::uint64_t slept = now - before;
+		const std::uint64_t overshoot = slept > request ? slept - request : 0;
+
+		if (overshoot > sleep_margin_)
+		{
+			sleep_margin_ += (overshoot - sleep_margin_) / 4;
+		}
+		else
+		{
+			sleep_margin_ -= (sleep_margin_ - overshoot) / 16;
+		}
+
+		sleep_margin_ = std::clamp(sleep_margin_, frequency_ / 5000, std::max(frame_period_ / 4, frequency_ / 5000));
+	}
+
+	while (now < next_deadline_)
+	{
+		now = SDL_GetPerformanceCounter();
+	}
+
+	next_deadline_ += frame_period_;
+}
+
+const FrameStats& FrameScheduler::GetStats()
+{
+	return stats_;
+}
+
+void FrameScheduler::ResetStats()
+{
+	stats_ = { 0, 0, 0, 0.0, 0.0, 0.0 };
+}
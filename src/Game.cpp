@@ -1,32 +1,59 @@
 #include "Game.hpp"
 #include "Constants.hpp"
+#include "Trace.hpp"
+#include "Zobrist.hpp"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
 
+#include <algorithm>
 #include <iostream>
 #include <cstdint>
-#include <string>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <utility>
 
-Game::Game() : 
+namespace
+{
+	// TTF_Init counts its callers, but FreeType's setup is not thread-safe, so headless games that
+	// load the HUD font do it one at a time.
+	std::mutex font_mutex;
+}
+
+Game::Game(bool headless) : 
 	running_(false), 
 	initialized_(false), 
+	headless_(headless), 
+	speed_(1.0), 
+	resets_(0), 
+	hash_(0), 
+	pellet_hash_(0), 
 	game_over_(false), 
 	level_completed_(false), 
 	score_(0), 
-	lives_(5), 
+	lives_(constants::starting_lives), 
 	levels_cleared_(0), 
 	game_ticks_(0), 
-	mode_timer_(0.0), 
+	mode_ticks_(0), 
 	level_(std::make_unique<Level>(this)), 
 	player_(std::make_unique<Player>(this)), 
-	game_over_texture_(std::make_unique<Texture>()), 
-	level_completed_texture_(std::make_unique<Texture>()), 
-	score_texture_(std::make_unique<Texture>()), 
-	lives_texture_(std::make_unique<Texture>()), 
-	levels_cleared_texture_(std::make_unique<Texture>()), 
+	glyph_atlas_(std::make_unique<GlyphAtlas>()), 
+	game_over_text_{ {}, 0, 0 }, 
+	level_completed_text_{ {}, 0, 0 }, 
+	score_text_("Score: "), 
+	lives_text_("Lives: "), 
+	levels_cleared_text_("Levels Cleared: "), 
+	draw_buffer_(std::make_unique<DrawBuffer>()), 
+	camera_(std::make_unique<Camera>()), 
+	frame_scheduler_(std::make_unique<FrameScheduler>()), 
+	metrics_(std::make_unique<Metrics>()), 
+	metrics_generation_(0), 
+	metrics_overlay_(false), 
 	window_(nullptr), 
 	renderer_(nullptr), 
 	font_(nullptr)
@@ -38,30 +65,25 @@ Game::Game() :
 		return;
 	}
 
-	level_->Initialize("res/levels/default.png");
+	// The compiled level is memory-mapped with no image decoding; the PNG is the authoring format.
+	if (!std::filesystem::exists(constants::compiled_level_path) || !level_->Initialize(constants::compiled_level_path))
+	{
+		level_->Initialize(constants::level_path);
+	}
 
 	player_->SetLevel(level_.get());
 	player_->Spawn();
+	pellet_hash_ = level_->GetPelletHash();
 
-	ghosts_.emplace_back(std::make_unique<Ghost>(this, level_.get(), GhostType::BLINKY));
-	ghosts_.emplace_back(std::make_unique<Ghost>(this, level_.get(), GhostType::INKY));
-	ghosts_.emplace_back(std::make_unique<Ghost>(this, level_.get(), GhostType::PINKY));
-	ghosts_.emplace_back(std::make_unique<Ghost>(this, level_.get(), GhostType::CLYDE));
+	SetGhostCount(constants::default_ghost_count);
 
-	std::for_each(ghosts_.begin(), ghosts_.end(), [this](const std::unique_ptr<Ghost>& ghost)
+	if (!headless_)
 	{
-		ghost->SetLevel(level_.get());
-	});
-
-	SDL_Color red_color = { 0xff, 0x00, 0x00, 0xff };
-	SDL_Color green_color = { 0x00, 0xff, 0x00, 0xff };
-
-	game_over_texture_->LoadFromText(renderer_, font_, "Game Over! Press 'r' to reset.", red_color);
-	level_completed_texture_->LoadFromText(renderer_, font_, "Level Completed! Press 'c' to continue.", green_color);
-
-	UpdateScoreTexture();
-	UpdateLivesTexture();
-	UpdateLevelsClearedTexture();
+		// HUD text is composed from one pre-rasterised glyph texture, so it never hits TTF again.
+		glyph_atlas_->Build(renderer_, font_);
+		glyph_atlas_->Layout("Game Over! Press 'r' to reset.", game_over_text_);
+		glyph_atlas_->Layout("Level Completed! Press 'c' to continue.", level_completed_text_);
+	}
 
 	board_viewport_.x = 0;
 	board_viewport_.y = 0;
@@ -73,7 +95,7 @@ Game::Game() :
 	info_viewport_.w = constants::info_width;
 	info_viewport_.h = constants::info_height;
 
-	mode_timer_ = SDL_GetTicks();	
+	camera_->SetSize(board_viewport_.w, board_viewport_.h);
 }
 
 Game::~Game()
@@ -83,6 +105,13 @@ Game::~Game()
 
 bool Game::Initialize()
 {
+	if (headless_)
+	{
+		// The simulation only needs the level image, which IMG_Load decodes without any global
+		// SDL subsystem, so headless games can coexist in one process.
+		return true;
+	}
+
 	if (SDL_Init(SDL_INIT_VIDEO) < 0)
 	{
 		printf("SDL could not be initialized! SDL Error: %s\n", SDL_GetError());
@@ -102,7 +131,7 @@ bool Game::Initialize()
 		return false;
 	}
 
-	renderer_ = SDL_CreateRenderer(window_, -1, SDL_RENDERER_ACCELERATED);
+	renderer_ = SDL_CreateRenderer(window_, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
 
 	if (renderer_ == nullptr)
 	{
@@ -132,11 +161,32 @@ bool Game::Initialize()
 		return false;
 	}
 
+	SetFrameMode(FrameMode::VSYNC);
+
 	return true;
 }
 
 void Game::Finalize()
 {
+	if (headless_)
+	{
+		if (font_ != nullptr)
+		{
+			std::lock_guard<std::mutex> lock(font_mutex);
+
+			glyph_atlas_->Free();
+			TTF_CloseFont(font_);
+			font_ = nullptr;
+			TTF_Quit();
+		}
+
+		return;
+	}
+
+	// Textures die with their renderer, so release the long-lived ones first.
+	level_->Free();
+	glyph_atlas_->Free();
+
 	SDL_DestroyWindow(window_);
 	window_ = nullptr;
 
@@ -153,6 +203,9 @@ void Game::Finalize()
 
 void Game::HandleEvents()
 {
+	METRICS_SCOPE(metrics_.get(), Phase::EVENTS);
+	TRACE_ZONE("Game::HandleEvents");
+
 	SDL_Event e;
 
 	while (SDL_PollEvent(&e) != 0)
@@ -162,15 +215,25 @@ void Game::HandleEvents()
 			running_ = false;
 			return;
 		}
+		else if (e.type == SDL_RENDER_TARGETS_RESET || e.type == SDL_RENDER_DEVICE_RESET)
+		{
+			level_->BuildMazeTexture();
+		}
 		else if (e.type == SDL_KEYDOWN)
 		{
-			if (game_over_ && e.key.keysym.sym == SDLK_r)
+			if ((game_over_ && e.key.keysym.sym == SDLK_r) || (level_completed_ && e.key.keysym.sym == SDLK_c))
 			{
+				RecordInput({ game_ticks_, InputType::RESET, Direction::NONE });
 				Reset();
 			}
-			else if (level_completed_ && e.key.keysym.sym == SDLK_c)
+			else if (e.key.keysym.sym == SDLK_BACKSPACE && rewind_ != nullptr)
 			{
-				Reset();
+				RewindTo(std::max(game_ticks_ - constants::tick_rate, rewind_->GetOldestTick()));
+			}
+			else if (e.key.keysym.sym == SDLK_F3)
+			{
+				metrics_overlay_ = !metrics_overlay_;
+				metrics_->SetEnabled(metrics_->IsOpen() || metrics_overlay_);
 			}
 		}
 
@@ -180,17 +243,63 @@ void Game::HandleEvents()
 
 void Game::Tick()
 {
-	if (++game_ticks_ % 20 == 0)
+	METRICS_SCOPE(metrics_.get(), Phase::TICK);
+	TRACE_ZONE("Game::Tick");
+
+	if (replay_ != nullptr)
+	{
+		for (const InputEvent* event = replay_->Peek(); event != nullptr && event->tick <= game_ticks_; event = replay_->Peek())
+		{
+			ApplyInput(*event);
+			replay_->Advance();
+		}
+	}
+
+	if (++game_ticks_ % constants::logic_step_ticks == 0)
 	{
 		if (!game_over_ && !level_completed_)
 		{
-			player_->Tick();
+			OccupancyGrid* occupancy = level_->GetOccupancy();
+			const int chase_tile = player_->GetCurrentTile();
+
+			occupancy->BeginStep();
 
-			std::for_each(ghosts_.begin(), ghosts_.end(), [this](const std::unique_ptr<Ghost>& ghost)
 			{
-				ghost->Tick();
+				METRICS_SCOPE(metrics_.get(), Phase::PLAYER);
+				player_->Tick();
+				occupancy->Move(Occupant::PLAYER, chase_tile, player_->GetCurrentTile(), level_->GetStepDirection(chase_tile, player_->GetCurrentTile()));
+			}
 
-				if (player_->GetCurrentTile() == ghost->GetCurrentTile())
+			// Eating the last item completes the level on the spot; nothing can catch the player after that.
+			if (!level_completed_)
+			{
+				{
+					METRICS_SCOPE(metrics_.get(), Phase::GHOSTS);
+
+					// Chasing ghosts aim where the player stood before this step; the route table already
+					// covers the classic four unless the level is too big for one.
+					if (GetGhostCount() > constants::default_ghost_count || !level_->HasRoutes())
+					{
+						level_->UpdateFlowField(chase_tile);
+					}
+
+					std::for_each(ghosts_.begin(), ghosts_.end(), [this, occupancy](Ghost& ghost)
+					{
+						const int from = ghost.GetCurrentTile();
+
+						ghost.Tick();
+						occupancy->Move(Occupant::GHOST, from, ghost.GetCurrentTile(), level_->GetStepDirection(from, ghost.GetCurrentTile()));
+					});
+				}
+
+				METRICS_SCOPE(metrics_.get(), Phase::COLLISION);
+
+				// Everyone moved at once: the player is caught by a ghost that ends the step on its tile,
+				// or by one that crossed the same edge the other way, swapping tiles with it.
+				const int player_tile = player_->GetCurrentTile();
+				const Direction step = level_->GetStepDirection(chase_tile, player_tile);
+
+				if (occupancy->GetCount(Occupant::GHOST, player_tile) > 0 || (step != Direction::NONE && occupancy->HasEntered(Occupant::GHOST, chase_tile, static_cast<Direction>(static_cast<int>(step) ^ 1))))
 				{
 					--lives_;
 
@@ -201,89 +310,260 @@ void Game::Tick()
 					else
 					{
 						Reset(false);
-						UpdateLivesTexture();
 					}
 				}
-			});
+			}
 		}
-
-		level_->Tick();
 	}
 
 	if (!game_over_ && !level_completed_)
 	{
-		if (ghosts_[0]->mode_ == GhostMode::SCATTER && (SDL_GetTicks() - mode_timer_) >= 7000.0)
+		const std::uint64_t previous_timer_key = zobrist::Key(zobrist::Feature::MODE_TICKS, 0, mode_ticks_);
+
+		// Mode timers count simulation ticks, so a run is identical at any playback speed.
+		++mode_ticks_;
+
+		if (ghosts_[0].mode_ == GhostMode::SCATTER && mode_ticks_ >= constants::scatter_ticks)
 		{
-			mode_timer_ += 7000.0;
+			mode_ticks_ -= constants::scatter_ticks;
 
-			std::for_each(ghosts_.begin(), ghosts_.end(), [](const std::unique_ptr<Ghost>& ghost)
+			std::for_each(ghosts_.begin(), ghosts_.end(), [](Ghost& ghost)
 			{
-				ghost->mode_ = GhostMode::CHASE;
+				ghost.SetMode(GhostMode::CHASE);
 			});
 		}
-		else if (ghosts_[0]->mode_ == GhostMode::CHASE && (SDL_GetTicks() - mode_timer_) >= 20000.0)
+		else if (ghosts_[0].mode_ == GhostMode::CHASE && mode_ticks_ >= constants::chase_ticks)
 		{
-			mode_timer_ += 20000.0;
+			mode_ticks_ -= constants::chase_ticks;
 
-			std::for_each(ghosts_.begin(), ghosts_.end(), [](const std::unique_ptr<Ghost>& ghost)
+			std::for_each(ghosts_.begin(), ghosts_.end(), [](Ghost& ghost)
 			{
-				ghost->mode_ = GhostMode::SCATTER;
+				ghost.SetMode(GhostMode::SCATTER);
 			});
 		}
+
+		ToggleHash(previous_timer_key ^ zobrist::Key(zobrist::Feature::MODE_TICKS, 0, mode_ticks_));
+	}
+
+	if (rewind_ != nullptr && game_ticks_ % constants::logic_step_ticks == 0 && rewind_->EndStep())
+	{
+		GameState keyframe;
+
+		if (Snapshot(keyframe))
+		{
+			rewind_->BeginSegment(keyframe);
+		}
+		else
+		{
+			rewind_.reset();
+		}
 	}
 }
 
 void Game::Render()
 {
+	METRICS_SCOPE(metrics_.get(), Phase::RENDER);
+	TRACE_ZONE("Game::Render");
+
+	draw_buffer_->BeginFrame();
+
 	SDL_SetRenderDrawColor(renderer_, 0x00, 0x00, 0x00, 0xff);
 	SDL_RenderClear(renderer_);
 
 	RenderBoard();
 
-	player_->Render();
-
-	std::for_each(ghosts_.begin(), ghosts_.end(), [](const std::unique_ptr<Ghost>& ghost)
-	{
-		ghost->Render();
-	});
-
 	RenderInfo();
 
+	METRICS_SCOPE(metrics_.get(), Phase::PRESENT);
+	TRACE_ZONE("SDL_RenderPresent");
 	SDL_RenderPresent(renderer_);
 }
 
 void Game::RenderBoard()
 {
+	METRICS_SCOPE(metrics_.get(), Phase::RENDER_BOARD);
+	TRACE_ZONE("Game::RenderBoard");
+
+	RecordBoard(true);
+
 	SDL_RenderSetViewport(renderer_, &board_viewport_);
 	
-	level_->Render();
+	draw_buffer_->Flush(renderer_);
+	draw_buffer_->SetOrigin(0, 0);
 
 	SDL_RenderSetViewport(renderer_, NULL);	
 }
 
+void Game::RecordBoard(bool use_maze_texture)
+{
+	// Board entities draw in board pixels; the draw buffer moves them into the camera's view.
+	camera_->Follow(level_->GetTileRect(player_->GetCurrentTile()), level_->GetBoardWidth(), level_->GetBoardHeight());
+	draw_buffer_->SetOrigin(camera_->GetView().x, camera_->GetView().y);
+
+	level_->Render(use_maze_texture);
+
+	{
+		METRICS_SCOPE(metrics_.get(), Phase::RENDER_ENTITIES);
+
+		player_->Render();
+
+		std::for_each(ghosts_.begin(), ghosts_.end(), [this](Ghost& ghost)
+		{
+			if (camera_->IsVisible(level_->GetTileRect(ghost.GetCurrentTile())))
+			{
+				ghost.Render();
+			}
+		});
+	}
+}
+
 void Game::RenderInfo()
 {
+	METRICS_SCOPE(metrics_.get(), Phase::RENDER_INFO);
+	TRACE_ZONE("Game::RenderInfo");
+
+	const SDL_Color white_color = { 0xff, 0xff, 0xff, 0xff };
+	const SDL_Color red_color = { 0xff, 0x00, 0x00, 0xff };
+	const SDL_Color green_color = { 0x00, 0xff, 0x00, 0xff };
+
 	SDL_RenderSetViewport(renderer_, &board_viewport_);
 
 	if (game_over_)
 	{
-		game_over_texture_->Render(renderer_, (constants::screen_width / 2) - (game_over_texture_->width_ / 2), (constants::board_height / 2) - (game_over_texture_->height_ / 2));
+		glyph_atlas_->Render(draw_buffer_.get(), game_over_text_, (constants::screen_width / 2) - (game_over_text_.width / 2), (constants::board_height / 2) - (game_over_text_.height / 2), red_color);
 	}
 
 	if (level_completed_)
 	{
-		level_completed_texture_->Render(renderer_, (constants::screen_width / 2) - (level_completed_texture_->width_ / 2), (constants::board_height / 2) - (level_completed_texture_->height_ / 2));
+		glyph_atlas_->Render(draw_buffer_.get(), level_completed_text_, (constants::screen_width / 2) - (level_completed_text_.width / 2), (constants::board_height / 2) - (level_completed_text_.height / 2), green_color);
 	}
 
+	draw_buffer_->Flush(renderer_);
+
 	SDL_RenderSetViewport(renderer_, &info_viewport_);
 
-	score_texture_->Render(renderer_, (constants::screen_width / 2) - (score_texture_->width_ / 2), (constants::info_height / 4));
-	lives_texture_->Render(renderer_, (constants::screen_width / 10), (constants::info_height - lives_texture_->height_));
-	levels_cleared_texture_->Render(renderer_, (constants::screen_width * 7 / 10) - (levels_cleared_texture_->width_ / 2), (constants::info_height - levels_cleared_texture_->height_));
+	if (metrics_overlay_)
+	{
+		RenderMetrics();
+	}
+	else
+	{
+		const TextLayout& score_text = score_text_.Update(*glyph_atlas_, score_);
+		const TextLayout& lives_text = lives_text_.Update(*glyph_atlas_, lives_);
+		const TextLayout& levels_cleared_text = levels_cleared_text_.Update(*glyph_atlas_, levels_cleared_);
+
+		glyph_atlas_->Render(draw_buffer_.get(), score_text, (constants::screen_width / 2) - (score_text.width / 2), (constants::info_height / 4), white_color);
+		glyph_atlas_->Render(draw_buffer_.get(), lives_text, (constants::screen_width / 10), (constants::info_height - lives_text.height), white_color);
+		glyph_atlas_->Render(draw_buffer_.get(), levels_cleared_text, (constants::screen_width * 7 / 10) - (levels_cleared_text.width / 2), (constants::info_height - levels_cleared_text.height), white_color);
+	}
+
+	draw_buffer_->Flush(renderer_);
 
 	SDL_RenderSetViewport(renderer_, NULL);
 }
 
+void Game::RenderMetrics()
+{
+	constexpr int phase_count = static_cast<int>(Phase::COUNT);
+	constexpr int rows = (phase_count + 2) / 2;
+
+	const SDL_Color yellow_color = { 0xff, 0xff, 0x00, 0xff };
+
+	// The summaries only change once per metrics interval, so only lay the text out again then.
+	if (metrics_text_.empty() || metrics_generation_ != metrics_->GetGeneration())
+	{
+		metrics_generation_ = metrics_->GetGeneration();
+		metrics_text_.resize(phase_count + 1);
+
+		glyph_atlas_->Layout("phase: p50 / p99 / max ms", metrics_text_[0], constants::metrics_text_scale);
+
+		for (int i = 0; i < phase_count; ++i)
+		{
+			const PhaseSummary& summary = metrics_->GetSummary(static_cast<Phase>(i));
+
+			char text[96];
+			snprintf(text, sizeof(text), "%s: %.3f / %.3f / %.3f", Metrics::GetPhaseName(static_cast<Phase>(i)), summary.p50_ms, summary.p99_ms, summary.max_ms);
+			glyph_atlas_->Layout(text, metrics_text_[i + 1], constants::metrics_text_scale);
+		}
+	}
+
+	for (std::size_t i = 0; i < metrics_text_.size(); ++i)
+	{
+		const int column = static_cast<int>(i) / rows;
+		const int row = static_cast<int>(i) % rows;
+
+		glyph_atlas_->Render(draw_buffer_.get(), metrics_text_[i], 16 + column * (constants::info_width / 2), row * (constants::info_height / rows), yellow_color);
+	}
+}
+
+void Game::RenderSoftware(SoftwareRenderer* renderer, std::uint8_t* pixels)
+{
+	TRACE_ZONE("Game::RenderSoftware");
+
+	const SDL_Color white_color = { 0xff, 0xff, 0xff, 0xff };
+	const SDL_Color red_color = { 0xff, 0x00, 0x00, 0xff };
+	const SDL_Color green_color = { 0x00, 0xff, 0x00, 0xff };
+
+	// The maze is drawn tile by tile: the maze texture lives on the GPU, out of the renderer's reach.
+	RecordBoard(false);
+	renderer->DrawRects(draw_buffer_.get(), board_viewport_);
+	draw_buffer_->SetOrigin(0, 0);
+
+	if (!glyph_atlas_->GetCoverage().empty())
+	{
+		if (game_over_)
+		{
+			renderer->DrawText(*glyph_atlas_, game_over_text_, board_viewport_, (constants::screen_width / 2) - (game_over_text_.width / 2), (constants::board_height / 2) - (game_over_text_.height / 2), red_color);
+		}
+
+		if (level_completed_)
+		{
+			renderer->DrawText(*glyph_atlas_, level_completed_text_, board_viewport_, (constants::screen_width / 2) - (level_completed_text_.width / 2), (constants::board_height / 2) - (level_completed_text_.height / 2), green_color);
+		}
+
+		const TextLayout& score_text = score_text_.Update(*glyph_atlas_, score_);
+		const TextLayout& lives_text = lives_text_.Update(*glyph_atlas_, lives_);
+		const TextLayout& levels_cleared_text = levels_cleared_text_.Update(*glyph_atlas_, levels_cleared_);
+
+		renderer->DrawText(*glyph_atlas_, score_text, info_viewport_, (constants::screen_width / 2) - (score_text.width / 2), (constants::info_height / 4), white_color);
+		renderer->DrawText(*glyph_atlas_, lives_text, info_viewport_, (constants::screen_width / 10), (constants::info_height - lives_text.height), white_color);
+		renderer->DrawText(*glyph_atlas_, levels_cleared_text, info_viewport_, (constants::screen_width * 7 / 10) - (levels_cleared_text.width / 2), (constants::info_height - levels_cleared_text.height), white_color);
+	}
+
+	renderer->Flush(pixels);
+}
+
+bool Game::LoadHudFont()
+{
+	if (font_ != nullptr)
+	{
+		return true;
+	}
+
+	std::lock_guard<std::mutex> lock(font_mutex);
+
+	if (TTF_Init() == -1)
+	{
+		printf("SDL_ttf could not be initialized! SDL_ttf Error: %s\n", TTF_GetError());
+		return false;
+	}
+
+	font_ = TTF_OpenFont("res/font/font.ttf", 38);
+
+	if (font_ == nullptr)
+	{
+		printf("Failed to load font! SDL_ttf Error: %s\n", TTF_GetError());
+		TTF_Quit();
+		return false;
+	}
+
+	glyph_atlas_->Build(nullptr, font_);
+	glyph_atlas_->Layout("Game Over! Press 'r' to reset.", game_over_text_);
+	glyph_atlas_->Layout("Level Completed! Press 'c' to continue.", level_completed_text_);
+
+	return true;
+}
+
 void Game::Run()
 {
 	if (!initialized_)
@@ -293,44 +573,464 @@ void Game::Run()
 
 	running_ = true;
 
-	constexpr long double ms = 1.0 / 60.0;
-	std::uint64_t last_time = SDL_GetPerformanceCounter();
-	long double delta = 0.0;
-
-	double timer = SDL_GetTicks();
-
-	int frames = 0;
-	int ticks = 0;
+	frame_scheduler_->ResetStats();
+	frame_scheduler_->Resync();
 
 	while (running_)
 	{
-		const std::uint64_t now = SDL_GetPerformanceCounter();
-		const long double elapsed = static_cast<long double>(now - last_time) / static_cast<long double>(SDL_GetPerformanceFrequency());
+		// Nothing moves behind the game over and level completed screens, so sleep until input arrives
+		// instead of redrawing the same frame. Replays keep ticking since they deliver their own reset.
+		const bool idle = (game_over_ || level_completed_) && replay_ == nullptr;
 
-		last_time = now;
-		delta += elapsed;
+		if (idle)
+		{
+			SDL_WaitEventTimeout(nullptr, constants::idle_wait_ms);
+			frame_scheduler_->Resync();
+		}
+
+		frame_scheduler_->BeginFrame(idle);
 
 		HandleEvents();
 
-		while (delta >= ms)
+		if (speed_ > 0.0)
 		{
-			Tick();
-			delta -= ms;
-			++ticks;
+			const int ticks = frame_scheduler_->TicksDue(speed_);
+
+			for (int i = 0; i < ticks; ++i)
+			{
+				Tick();
+			}
+		}
+		else
+		{
+			// Unbounded: simulate as fast as possible and only stop to render once per display tick.
+			const std::uint64_t render_deadline = SDL_GetPerformanceCounter() + SDL_GetPerformanceFrequency() / constants::tick_rate;
+
+			do
+			{
+				for (int i = 0; i < 64; ++i)
+				{
+					Tick();
+				}
+			}
+			while (SDL_GetPerformanceCounter() < render_deadline);
 		}
 
-		//printf("%Lf\n", delta / ms);
 		Render();
-		++frames;
 
-		if (SDL_GetTicks() - timer > 1000)
+		frame_scheduler_->EndFrame();
+
+		metrics_->Update();
+	}
+
+	metrics_->Update(true);
+
+	const FrameStats& stats = frame_scheduler_->GetStats();
+
+	if (stats.frames > 0)
+	{
+		printf("Frames: %llu (%llu idle), %.2f ms/frame, CPU %.2f ms/frame (max %.2f ms), %llu ticks dropped\n", 
+			static_cast<unsigned long long>(stats.frames), static_cast<unsigned long long>(stats.idle_frames), 
+			stats.wall_seconds * 1000.0 / stats.frames, stats.cpu_seconds * 1000.0 / stats.frames, stats.max_cpu_seconds * 1000.0, 
+			static_cast<unsigned long long>(stats.dropped_ticks));
+	}
+}
+
+void Game::RunHeadless(int ticks, const InputScript& script, bool auto_reset)
+{
+	if (!initialized_ || !headless_)
+	{
+		return;
+	}
+
+	const int first_tick = game_ticks_;
+	const std::uint64_t start = SDL_GetPerformanceCounter();
+
+	const int resets = Simulate(ticks, script, auto_reset);
+
+	metrics_->Update(true);
+
+	const std::uint64_t end = SDL_GetPerformanceCounter();
+	const double seconds = static_cast<double>(end - start) / static_cast<double>(SDL_GetPerformanceFrequency());
+	const int logic_steps = game_ticks_ / constants::logic_step_ticks - first_tick / constants::logic_step_ticks;
+
+	printf("Simulated %d ticks (%d logic steps, %d resets) in %.3f s\n", ticks, logic_steps, resets, seconds);
+
+	if (seconds > 0.0)
+	{
+		printf("Ticks/s: %.0f, Logic steps/s: %.0f\n", ticks / seconds, logic_steps / seconds);
+	}
+
+	printf("Score: %d, Lives: %d, Levels Cleared: %d\n", score_, lives_, levels_cleared_);
+}
+
+int Game::Simulate(int ticks, const InputScript& script, bool auto_reset)
+{
+	if (!initialized_ || !headless_)
+	{
+		return 0;
+	}
+
+	running_ = true;
+
+	const int first_reset = resets_;
+	std::size_t next_event = 0;
+
+	while (next_event < script.size() && script[next_event].tick < game_ticks_)
+	{
+		++next_event;
+	}
+
+	for (int i = 0; i < ticks && running_; ++i)
+	{
+		if (auto_reset && (game_over_ || level_completed_))
+		{
+			Reset();
+		}
+
+		while (next_event < script.size() && script[next_event].tick == game_ticks_)
 		{
-			timer += 1000;
-			//printf("Frames: %d, Ticks: %d\n", frames, ticks);
-			frames = 0;
-			ticks = 0;
+			ApplyInput(script[next_event]);
+			++next_event;
 		}
+
+		Tick();
 	}
+
+	running_ = false;
+
+	return resets_ - first_reset;
+}
+
+void Game::ApplyInput(const InputEvent& event)
+{
+	if (rewind_ != nullptr)
+	{
+		rewind_->RecordInput(event);
+	}
+
+	if (event.type == InputType::RESET)
+	{
+		if (game_over_ || level_completed_)
+		{
+			Reset();
+		}
+	}
+	else
+	{
+		player_->SetDirection(event.direction);
+	}
+}
+
+void Game::RecordInput(const InputEvent& event)
+{
+	if (recorder_ != nullptr)
+	{
+		recorder_->Record(event);
+	}
+
+	if (rewind_ != nullptr)
+	{
+		rewind_->RecordInput(event);
+	}
+}
+
+void Game::StartRecording()
+{
+	recorder_ = std::make_unique<ReplayRecorder>();
+}
+
+bool Game::SaveRecording(const char* path)
+{
+	if (recorder_ == nullptr)
+	{
+		return false;
+	}
+
+	const ReplayHeader header = 
+	{
+		static_cast<std::uint16_t>(constants::tick_rate), 
+		static_cast<std::uint16_t>(constants::logic_step_ticks), 
+		static_cast<std::uint16_t>(constants::starting_lives), 
+		static_cast<std::uint32_t>(game_ticks_), 
+		level_->GetHash(), 
+		static_cast<std::uint32_t>(GetGhostCount())
+	};
+
+	return recorder_->Save(path, header);
+}
+
+bool Game::LoadLevel(const char* path)
+{
+	if (!level_->Initialize(path))
+	{
+		return false;
+	}
+
+	// Spawns and scatter corners depend on the level, so everyone starts over on the new board.
+	pellet_hash_ = level_->GetPelletHash();
+	player_->Spawn();
+	SetGhostCount(GetGhostCount());
+
+	return true;
+}
+
+void Game::SetGhostCount(int count)
+{
+	constexpr GhostType classic_types[] = { GhostType::BLINKY, GhostType::INKY, GhostType::PINKY, GhostType::CLYDE };
+
+	mode_ticks_ = 0;
+	ghosts_.clear();
+	ghosts_.reserve(count);
+
+	for (int i = 0; i < count && i < constants::default_ghost_count; ++i)
+	{
+		ghosts_.emplace_back(this, level_.get(), classic_types[i], i);
+	}
+
+	// Swarm spawns are drawn from a generator seeded with the count, so a level and a count always
+	// give the same swarm and recordings replay exactly.
+	std::mt19937 rng(static_cast<std::uint32_t>(count));
+	std::uniform_int_distribution<int> tile(0, level_->GetTileCount() - 1);
+	const int player_spawn = level_->GetSpawn(SpawnPoint::PLAYER);
+
+	for (int i = constants::default_ghost_count; i < count; ++i)
+	{
+		int spawn = level_->GetSpawn(SpawnPoint::BLINKY);
+
+		for (int attempt = 0; attempt < 1024; ++attempt)
+		{
+			const int candidate = tile(rng);
+
+			if (!level_->IsWall(candidate) && level_->TileDistance(candidate, player_spawn) >= constants::swarm_spawn_distance)
+			{
+				spawn = candidate;
+				break;
+			}
+		}
+
+		ghosts_.emplace_back(this, level_.get(), GhostType::SWARM, i, spawn);
+	}
+
+	PlaceOccupants();
+	hash_ = pellet_hash_ ^ HashEntities();
+}
+
+int Game::GetGhostCount()
+{
+	return static_cast<int>(ghosts_.size());
+}
+
+bool Game::Snapshot(GameState& state)
+{
+	if (level_->GetTileCount() > GameState::max_tiles || GetGhostCount() > GameState::max_ghosts)
+	{
+		return false;
+	}
+
+	// Unused slots and padding are zeroed so equal games give byte-identical states.
+	std::memset(&state, 0, sizeof(state));
+
+	state.hash = hash_;
+	state.pellet_hash = pellet_hash_;
+	state.score = score_;
+	state.lives = lives_;
+	state.levels_cleared = levels_cleared_;
+	state.game_ticks = game_ticks_;
+	state.mode_ticks = mode_ticks_;
+	state.game_over = game_over_;
+	state.level_completed = level_completed_;
+	state.ghost_count = static_cast<std::uint16_t>(GetGhostCount());
+
+	player_->Snapshot(state.player);
+
+	for (int i = 0; i < GetGhostCount(); ++i)
+	{
+		ghosts_[i].Snapshot(state.ghosts[i]);
+	}
+
+	level_->Snapshot(state);
+
+	return true;
+}
+
+void Game::Restore(const GameState& state)
+{
+	if (state.ghost_count != GetGhostCount())
+	{
+		SetGhostCount(state.ghost_count);
+	}
+
+	score_ = state.score;
+	lives_ = state.lives;
+	levels_cleared_ = state.levels_cleared;
+	game_ticks_ = state.game_ticks;
+	mode_ticks_ = state.mode_ticks;
+	game_over_ = state.game_over != 0;
+	level_completed_ = state.level_completed != 0;
+
+	player_->Restore(state.player);
+
+	for (int i = 0; i < GetGhostCount(); ++i)
+	{
+		ghosts_[i].Restore(state.ghosts[i]);
+	}
+
+	level_->Restore(state);
+
+	PlaceOccupants();
+
+	hash_ = state.hash;
+	pellet_hash_ = state.pellet_hash;
+}
+
+void Game::Step(GameState& state, Direction input)
+{
+	// The search's ticks are not the game's: keep them out of the rewind ring, the recording and
+	// the replay's position.
+	std::unique_ptr<ReplayRecorder> recorder = std::move(recorder_);
+	std::unique_ptr<Rewind> rewind = std::move(rewind_);
+	std::unique_ptr<ReplayReader> replay = std::move(replay_);
+
+	Restore(state);
+	player_->SetDirection(input);
+
+	// Any logic_step_ticks consecutive ticks contain exactly one logic step.
+	for (int i = 0; i < constants::logic_step_ticks; ++i)
+	{
+		Tick();
+	}
+
+	Snapshot(state);
+
+	recorder_ = std::move(recorder);
+	rewind_ = std::move(rewind);
+	replay_ = std::move(replay);
+}
+
+bool Game::StartRewind(int seconds)
+{
+	GameState keyframe;
+
+	if (!Snapshot(keyframe))
+	{
+		printf("Rewind needs a level of at most %d tiles and at most %d ghosts!\n", GameState::max_tiles, GameState::max_ghosts);
+		return false;
+	}
+
+	rewind_ = std::make_unique<Rewind>(seconds, constants::rewind_keyframe_steps);
+	rewind_->BeginSegment(keyframe);
+
+	return true;
+}
+
+bool Game::RewindTo(int tick)
+{
+	GameState keyframe;
+	InputScript inputs;
+
+	if (rewind_ == nullptr || tick > game_ticks_ || !rewind_->Truncate(tick, keyframe, inputs))
+	{
+		return false;
+	}
+
+	Restore(keyframe);
+	rewind_->BeginSegment(keyframe);
+
+	// Re-simulating re-records the segment, which also checks it comes out the same as the first time.
+	std::size_t next = 0;
+
+	while (game_ticks_ < tick)
+	{
+		for (; next < inputs.size() && inputs[next].tick <= game_ticks_; ++next)
+		{
+			ApplyInput(inputs[next]);
+		}
+
+		Tick();
+	}
+
+	if (!rewind_->FinishSeek())
+	{
+		printf("Rewind to tick %d did not reproduce the recorded run!\n", tick);
+	}
+
+	return true;
+}
+
+Rewind* Game::GetRewind()
+{
+	return rewind_.get();
+}
+
+bool Game::LoadReplay(const char* path)
+{
+	replay_ = std::make_unique<ReplayReader>();
+
+	if (!replay_->Open(path))
+	{
+		replay_.reset();
+		return false;
+	}
+
+	const ReplayHeader& header = replay_->GetHeader();
+
+	if (header.level_hash != level_->GetHash() || header.tick_rate != constants::tick_rate || header.logic_step_ticks != constants::logic_step_ticks || header.starting_lives != constants::starting_lives || header.ghost_count == 0 || header.ghost_count > constants::max_ghost_count)
+	{
+		printf("Replay %s was recorded with a different level or settings!\n", path);
+		replay_.reset();
+		return false;
+	}
+
+	// The swarm follows from the level and the count, so the replay brings its own ghosts along.
+	if (static_cast<int>(header.ghost_count) != GetGhostCount())
+	{
+		SetGhostCount(static_cast<int>(header.ghost_count));
+	}
+
+	return true;
+}
+
+int Game::GetReplayLength()
+{
+	return replay_ != nullptr ? static_cast<int>(replay_->GetHeader().length_ticks) : 0;
+}
+
+void Game::SetSpeed(double speed)
+{
+	speed_ = speed;
+}
+
+void Game::SetFrameMode(FrameMode mode, double target_fps)
+{
+	if (headless_ || renderer_ == nullptr)
+	{
+		frame_scheduler_->SetMode(mode, target_fps);
+		return;
+	}
+
+	// Capped mode falls back to the display rate when no target is given, and so does vsync if the
+	// driver refuses to sync, so a missing vsync never turns into a busy loop.
+	SDL_DisplayMode display_mode;
+
+	if (target_fps <= 0.0 && SDL_GetWindowDisplayMode(window_, &display_mode) == 0 && display_mode.refresh_rate > 0)
+	{
+		target_fps = display_mode.refresh_rate;
+	}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	SDL_RenderSetVSync(renderer_, mode == FrameMode::VSYNC ? 1 : 0);
+#endif
+
+	SDL_RendererInfo info;
+
+	if (mode == FrameMode::VSYNC && (SDL_GetRendererInfo(renderer_, &info) != 0 || (info.flags & SDL_RENDERER_PRESENTVSYNC) == 0))
+	{
+		printf("Vsync is unavailable, capping at %.0f fps instead.\n", target_fps > 0.0 ? target_fps : constants::tick_rate);
+		mode = FrameMode::CAPPED;
+	}
+
+	frame_scheduler_->SetMode(mode, target_fps);
 }
 
 void Game::Stop()
@@ -340,60 +1040,142 @@ void Game::Stop()
 
 void Game::Reset(bool reset_pellets)
 {
+	TRACE_ZONE("Game::Reset");
+
+	if (game_over_ || level_completed_)
+	{
+		++resets_;
+	}
+
 	if (game_over_)
 	{
 		score_ = 0;
 		levels_cleared_ = 0;
-		lives_ = 5;
+		lives_ = constants::starting_lives;
 		game_over_ = false;
-		UpdateScoreTexture();
-		UpdateLivesTexture();
-		UpdateLevelsClearedTexture();
 	}
 	else if (level_completed_)
 	{
 		++levels_cleared_;
 		level_completed_ = false;
-		UpdateLevelsClearedTexture();
 	}
 
-	mode_timer_ = 0.0;
+	mode_ticks_ = 0;
+
+	if (rewind_ != nullptr)
+	{
+		rewind_->RecordReset();
+	}
 
 	if (reset_pellets)
 	{
 		level_->Reset();
+		pellet_hash_ = level_->GetPelletHash();
 	}
 
 	player_->Spawn();
 
-	std::for_each(ghosts_.begin(), ghosts_.end(), [](const std::unique_ptr<Ghost>& ghost)
+	std::for_each(ghosts_.begin(), ghosts_.end(), [](Ghost& ghost)
 	{
-		ghost->Spawn();
+		ghost.Spawn();
 	});
+
+	PlaceOccupants();
+	hash_ = pellet_hash_ ^ HashEntities();
 }
 
-void Game::UpdateScoreTexture()
+void Game::PlaceOccupants()
 {
-	SDL_Color white_color = { 0xff, 0xff, 0xff, 0xff };
-	const std::string score_text = "Score: " + std::to_string(score_);
-	score_texture_->LoadFromText(renderer_, font_, score_text.c_str(), white_color);
+	OccupancyGrid* occupancy = level_->GetOccupancy();
+
+	occupancy->Clear();
+	occupancy->Add(Occupant::PLAYER, player_->GetCurrentTile());
+
+	std::for_each(ghosts_.begin(), ghosts_.end(), [occupancy](Ghost& ghost)
+	{
+		occupancy->Add(Occupant::GHOST, ghost.GetCurrentTile());
+	});
 }
-	
-void Game::UpdateLivesTexture()
+
+std::uint64_t Game::HashEntities()
 {
-	SDL_Color white_color = { 0xff, 0xff, 0xff, 0xff };
-	const std::string lives_text = "Lives: " + std::to_string(lives_);
-	lives_texture_->LoadFromText(renderer_, font_, lives_text.c_str(), white_color);
+	std::uint64_t hash = player_->GetHashKey() ^ zobrist::Key(zobrist::Feature::MODE_TICKS, 0, mode_ticks_);
+
+	std::for_each(ghosts_.begin(), ghosts_.end(), [&hash](Ghost& ghost)
+	{
+		hash ^= ghost.GetHashKey();
+	});
+
+	return hash;
 }
-	
-void Game::UpdateLevelsClearedTexture()
+
+std::uint64_t Game::GetStateHash() const
 {
-	SDL_Color white_color = { 0xff, 0xff, 0xff, 0xff };
-	const std::string levels_cleared_text = "Levels Cleared: " + std::to_string(levels_cleared_);
-	levels_cleared_texture_->LoadFromText(renderer_, font_, levels_cleared_text.c_str(), white_color);
+	return hash_;
+}
+
+std::uint64_t Game::ComputeStateHash()
+{
+	std::uint64_t hash = HashEntities();
+
+	for (int i = 0; i < level_->GetTileCount(); ++i)
+	{
+		if (level_->HasPellet(i))
+		{
+			hash ^= zobrist::Key(zobrist::Feature::PELLET, 0, i);
+		}
+
+		if (level_->HasEnergizer(i))
+		{
+			hash ^= zobrist::Key(zobrist::Feature::ENERGIZER, 0, i);
+		}
+	}
+
+	return hash;
+}
+
+void Game::ToggleHash(std::uint64_t key)
+{
+	hash_ ^= key;
+}
+
+void Game::TogglePelletHash(std::uint64_t key)
+{
+	hash_ ^= key;
+	pellet_hash_ ^= key;
 }
 
 Player* Game::GetPlayer()
 {
 	return player_.get();
 }
+
+DrawBuffer* Game::GetDrawBuffer()
+{
+	return draw_buffer_.get();
+}
+
+Camera* Game::GetCamera()
+{
+	return camera_.get();
+}
+
+Level* Game::GetLevel()
+{
+	return level_.get();
+}
+
+const DrawStats& Game::GetDrawStats()
+{
+	return draw_buffer_->GetLastFrameStats();
+}
+
+const FrameStats& Game::GetFrameStats()
+{
+	return frame_scheduler_->GetStats();
+}
+
+Metrics* Game::GetMetrics()
+{
+	return metrics_.get();
+}
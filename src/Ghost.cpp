@@ -1,18 +1,23 @@
 #include "Ghost.hpp"
 #include "Game.hpp"
+#include "Trace.hpp"
+#include "Zobrist.hpp"
 
 #include <SDL2/SDL.h>
 
+#include <cstdint>
 #include <iostream>
 
-Ghost::Ghost(Game* game, Level* level, GhostType type) : 
+Ghost::Ghost(Game* game, Level* level, GhostType type, int index, int spawn_tile) : 
 	Entity(game), 
 	type_(type), 
 	mode_(GhostMode::SCATTER), 
-	target_tile_(nullptr), 
-	scatter_target_tile_(nullptr), 
-	home_porch_target_tile_(nullptr), 
-	home_target_tile_(nullptr)
+	target_tile_(-1), 
+	scatter_target_tile_(-1), 
+	home_porch_target_tile_(-1), 
+	home_target_tile_(-1), 
+	spawn_tile_(spawn_tile), 
+	index_(index)
 {
 	SetLevel(level);
 	Spawn();
@@ -24,110 +29,178 @@ Ghost::~Ghost()
 
 void Ghost::Spawn()
 {
+	// Scatter targets are the board's corner tiles, whatever size the level is.
+	const int right = level_->GetBoardWidth() - level_->GetTileSize();
+	const int bottom = level_->GetBoardHeight() - level_->GetTileSize();
+
 	if (type_ == GhostType::BLINKY)
 	{
-		current_tile_ = level_->GetTile(352, 416);
-		scatter_target_tile_ = level_->GetTile(864, 0);
+		current_tile_ = level_->GetSpawn(SpawnPoint::BLINKY);
+		scatter_target_tile_ = level_->GetTileIndex(right, 0);
 	}
 	else if (type_ == GhostType::INKY)
 	{
-		current_tile_ = level_->GetTile(352, 480);
-		scatter_target_tile_ = level_->GetTile(864, 960);
+		current_tile_ = level_->GetSpawn(SpawnPoint::INKY);
+		scatter_target_tile_ = level_->GetTileIndex(right, bottom);
 	}
 	else if (type_ == GhostType::PINKY)
 	{
-		current_tile_ = level_->GetTile(512, 416);
-		scatter_target_tile_ = level_->GetTile(0, 0);
+		current_tile_ = level_->GetSpawn(SpawnPoint::PINKY);
+		scatter_target_tile_ = level_->GetTileIndex(0, 0);
 	}
 	else if (type_ == GhostType::CLYDE)
 	{
-		current_tile_ = level_->GetTile(512, 480);
-		scatter_target_tile_ = level_->GetTile(0, 960);
+		current_tile_ = level_->GetSpawn(SpawnPoint::CLYDE);
+		scatter_target_tile_ = level_->GetTileIndex(0, bottom);
+	}
+	else if (type_ == GhostType::SWARM)
+	{
+		const SDL_Rect spawn = level_->GetTileRect(spawn_tile_);
+
+		current_tile_ = spawn_tile_;
+		scatter_target_tile_ = level_->GetTileIndex(spawn.x * 2 >= level_->GetBoardWidth() ? right : 0, spawn.y * 2 >= level_->GetBoardHeight() ? bottom : 0);
 	}
 
 	home_target_tile_ = current_tile_;
-	home_porch_target_tile_ = level_->GetTile(416, 352);
-	target_tile_ = home_porch_target_tile_;
+	home_porch_target_tile_ = level_->GetSpawn(SpawnPoint::HOME_PORCH);
+
+	// Swarm ghosts start out on the board rather than in the ghost house, so they skip the porch.
+	target_tile_ = type_ == GhostType::SWARM ? scatter_target_tile_ : home_porch_target_tile_;
 }
 
 void Ghost::Tick()
 {
+	const int previous_tile = current_tile_;
+
 	Move();
 	UpdateTargetCells();
+
+	if (current_tile_ != previous_tile && game_->GetRewind() != nullptr)
+	{
+		game_->GetRewind()->RecordGhostTile(index_, current_tile_);
+	}
 }
 
 void Ghost::Render()
 {
 	//DebugNeighbors();
 
+	SDL_Color color = { 0x00, 0x00, 0x00, 0xff };
+
 	if (type_ == GhostType::BLINKY)
 	{
-		SDL_SetRenderDrawColor(game_->renderer_, 0xff, 0x00, 0x00, 0xff);
+		color = { 0xff, 0x00, 0x00, 0xff };
 	}
 	else if (type_ == GhostType::INKY)
 	{
-		SDL_SetRenderDrawColor(game_->renderer_, 0x00, 0xff, 0xff, 0xff);
+		color = { 0x00, 0xff, 0xff, 0xff };
 	}
 	else if (type_ == GhostType::PINKY)
 	{
-		SDL_SetRenderDrawColor(game_->renderer_, 0xff, 0xb8, 0xff, 0xff);
+		color = { 0xff, 0xb8, 0xff, 0xff };
 	}
 	else if (type_ == GhostType::CLYDE)
 	{
-		SDL_SetRenderDrawColor(game_->renderer_, 0xff, 0xb8, 0x51, 0xff);
+		color = { 0xff, 0xb8, 0x51, 0xff };
+	}
+	else if (type_ == GhostType::SWARM)
+	{
+		color = { 0x21, 0x21, 0xde, 0xff };
 	}
 	
-	SDL_RenderFillRect(game_->renderer_, &current_tile_->rect_);
-	//SDL_RenderFillRect(game_->renderer_, &target_tile_->rect_);
+	game_->GetDrawBuffer()->FillRect(DrawLayer::GHOSTS, level_->GetTileRect(current_tile_), color.r, color.g, color.b, color.a);
+	//game_->GetDrawBuffer()->FillRect(DrawLayer::DEBUG, level_->GetTileRect(target_tile_), color.r, color.g, color.b, color.a);
 }
 
 void Ghost::Move()
 {
-	const std::vector<Tile*> neighbors = level_->GetNeighborTiles(current_tile_->rect_.x, current_tile_->rect_.y);
-	Tile* next_tile = nullptr;
+	TRACE_ZONE("Ghost::Move");
+
+	const std::uint64_t previous_key = GetHashKey();
+	const std::array<int, 4> neighbors = level_->GetNeighbors(current_tile_);
+	int next_tile = -1;
 	Direction next_direction = Direction::NONE;
+	const FlowField* flow_field = level_->GetFlowField();
 
-	for (std::size_t i = 0; i < neighbors.size(); ++i)
+	if (target_tile_ != -1 && flow_field->GetTarget() == target_tile_ && (type_ == GhostType::SWARM || !level_->HasRoutes()))
 	{
-		if (neighbors[i] == nullptr || neighbors[i]->IsWall())
-		{
-			continue;
-		}
+		// The shared field already knows every tile's distance to the player; take the closest step.
+		int best_distance = 0;
 
-		const int dir = static_cast<int>(direction_);
-		const int current = static_cast<int>(i);
-
-		if ((dir == 1 && current == 0) || (dir == 0 && current == 1) || (dir == 2 && current == 3) || (dir == 3 && current == 2))
+		for (int i = 0; i < 4; ++i)
 		{
-			continue;
-		}
+			if (!CanMove(static_cast<Direction>(i)))
+			{
+				continue;
+			}
 
-		if (current_tile_->type_ != TileType::GHOST_HOME && neighbors[i]->type_ == TileType::GHOST_GATE)
-		{
-			continue;
+			if (next_tile == -1 || flow_field->GetDistance(neighbors[i]) < best_distance)
+			{
+				next_tile = neighbors[i];
+				next_direction = static_cast<Direction>(i);
+				best_distance = flow_field->GetDistance(neighbors[i]);
+			}
 		}
+	}
+	else if (level_->HasRoutes())
+	{
+		std::uint8_t route = level_->GetRoute(current_tile_, target_tile_);
 
-		if (current_tile_->type_ == TileType::GHOST_CROSSROAD && i == 2)
+		for (int rank = 0; rank < 4; ++rank, route >>= 2)
 		{
-			continue;
-		}
+			const Direction direction = static_cast<Direction>(route & 0x3);
 
-		if (next_tile == nullptr)
-		{
-			next_tile = neighbors[i];
-			next_direction = static_cast<Direction>(i);
-			continue;
+			if (CanMove(direction))
+			{
+				next_tile = neighbors[static_cast<int>(direction)];
+				next_direction = direction;
+				break;
+			}
 		}
-
-		if (level_->TileDistance(*neighbors[i], *target_tile_) < level_->TileDistance(*current_tile_, *target_tile_))
+	}
+	else
+	{
+		for (int i = 0; i < 4; ++i)
 		{
-			next_tile = neighbors[i];
-			next_direction = static_cast<Direction>(i);
+			if (!CanMove(static_cast<Direction>(i)))
+			{
+				continue;
+			}
+
+			if (next_tile == -1)
+			{
+				next_tile = neighbors[i];
+				next_direction = static_cast<Direction>(i);
+				continue;
+			}
+
+			if (level_->TileDistance(neighbors[i], target_tile_) < level_->TileDistance(current_tile_, target_tile_))
+			{
+				next_tile = neighbors[i];
+				next_direction = static_cast<Direction>(i);
+			}
 		}
 	}
 
-	current_tile_ = next_tile;
+	if (next_tile != -1)
+	{
+		current_tile_ = next_tile;
+	}
+
 	direction_ = next_direction;
+
+	game_->ToggleHash(previous_key ^ GetHashKey());
+}
+
+bool Ghost::CanMove(Direction direction)
+{
+	// Ghosts never reverse; Direction pairs differ only in the lowest bit.
+	if (direction_ != Direction::NONE && static_cast<int>(direction) == (static_cast<int>(direction_) ^ 1))
+	{
+		return false;
+	}
+
+	return level_->CanGhostStep(current_tile_, direction);
 }
 
 void Ghost::UpdateTargetCells()
@@ -148,7 +221,7 @@ void Ghost::UpdateTargetCells()
 		return;
 	}
 
-	if (type_ == GhostType::BLINKY)
+	if (type_ == GhostType::BLINKY || type_ == GhostType::SWARM)
 	{
 		target_tile_ = game_->GetPlayer()->GetCurrentTile();
 	}
@@ -182,7 +255,7 @@ void Ghost::UpdateTargetCells()
 	}
 	else if (type_ == GhostType::CLYDE)
 	{
-		if (level_->TileDistance(*current_tile_, *game_->GetPlayer()->GetCurrentTile()) < 5)
+		if (level_->GetOccupancy()->CountWithin(Occupant::PLAYER, current_tile_, 4) > 0)
 		{
 			target_tile_ = scatter_target_tile_;
 		}
@@ -192,3 +265,32 @@ void Ghost::UpdateTargetCells()
 		}
 	}
 }
+
+void Ghost::SetMode(GhostMode mode)
+{
+	const std::uint64_t previous_key = zobrist::Key(zobrist::Feature::GHOST_MODE, index_, static_cast<std::uint32_t>(mode_));
+
+	mode_ = mode;
+	game_->ToggleHash(previous_key ^ zobrist::Key(zobrist::Feature::GHOST_MODE, index_, static_cast<std::uint32_t>(mode_)));
+}
+
+std::uint64_t Ghost::GetHashKey() const
+{
+	return zobrist::Key(zobrist::Feature::GHOST_TILE, index_, current_tile_) ^ zobrist::Key(zobrist::Feature::GHOST_DIRECTION, index_, static_cast<std::uint32_t>(direction_)) ^ zobrist::Key(zobrist::Feature::GHOST_MODE, index_, static_cast<std::uint32_t>(mode_));
+}
+
+void Ghost::Snapshot(GhostState& state) const
+{
+	state.tile = current_tile_;
+	state.target_tile = target_tile_;
+	state.direction = static_cast<std::uint8_t>(direction_);
+	state.mode = static_cast<std::uint8_t>(mode_);
+}
+
+void Ghost::Restore(const GhostState& state)
+{
+	current_tile_ = state.tile;
+	target_tile_ = state.target_tile;
+	direction_ = static_cast<Direction>(state.direction);
+	mode_ = static_cast<GhostMode>(state.mode);
+}
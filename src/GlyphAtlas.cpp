@@ -0,0 +1,207 @@
+#include "GlyphAtlas.hpp"
+#include "Trace.hpp"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <algorithm>
+#include <string>
+
+GlyphAtlas::GlyphAtlas() : texture_(std::make_unique<Texture>()), line_height_(0), coverage_width_(0)
+{
+	glyphs_.fill({ 0, 0, 0, 0 });
+	offsets_.fill(0);
+	advances_.fill(0);
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+	Free();
+}
+
+bool GlyphAtlas::Build(SDL_Renderer* renderer, TTF_Font* font)
+{
+	TRACE_ZONE("GlyphAtlas::Build");
+
+	Free();
+
+	constexpr int atlas_width = 512;
+	constexpr int padding = 1;
+
+	const SDL_Color white_color = { 0xff, 0xff, 0xff, 0xff };
+	std::array<SDL_Surface*, glyph_count> surfaces;
+	surfaces.fill(nullptr);
+
+	line_height_ = TTF_FontHeight(font);
+
+	int pen_x = padding;
+	int pen_y = padding;
+	int row_height = 0;
+
+	for (int i = 0; i < glyph_count; ++i)
+	{
+		const Uint16 glyph = static_cast<Uint16>(first_glyph + i);
+		int min_x = 0;
+
+		if (TTF_GlyphMetrics(font, glyph, &min_x, nullptr, nullptr, nullptr, &advances_[i]) != 0)
+		{
+			continue;
+		}
+
+		// Glyph surfaces are shifted left by any negative bearing, exactly like TTF_RenderText does.
+		offsets_[i] = std::min(0, min_x);
+		surfaces[i] = TTF_RenderGlyph_Blended(font, glyph, white_color);
+
+		if (surfaces[i] == nullptr)
+		{
+			continue;
+		}
+
+		if (pen_x + surfaces[i]->w + padding > atlas_width)
+		{
+			pen_x = padding;
+			pen_y += row_height + padding;
+			row_height = 0;
+		}
+
+		glyphs_[i] = { pen_x, pen_y, surfaces[i]->w, surfaces[i]->h };
+		pen_x += surfaces[i]->w + padding;
+		row_height = std::max(row_height, surfaces[i]->h);
+	}
+
+	SDL_Surface* atlas_surface = SDL_CreateRGBSurfaceWithFormat(0, atlas_width, pen_y + row_height + padding, 32, SDL_PIXELFORMAT_RGBA32);
+
+	if (atlas_surface == nullptr)
+	{
+		printf("Unable to create glyph atlas surface! SDL Error: %s\n", SDL_GetError());
+	}
+
+	for (int i = 0; i < glyph_count; ++i)
+	{
+		if (surfaces[i] == nullptr)
+		{
+			continue;
+		}
+
+		if (atlas_surface != nullptr)
+		{
+			SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+			SDL_BlitSurface(surfaces[i], nullptr, atlas_surface, &glyphs_[i]);
+		}
+
+		SDL_FreeSurface(surfaces[i]);
+	}
+
+	if (atlas_surface == nullptr)
+	{
+		return false;
+	}
+
+	// The glyphs are white, so their alpha is all the software renderer needs.
+	coverage_width_ = atlas_surface->w;
+	coverage_.resize(static_cast<std::size_t>(atlas_surface->w) * atlas_surface->h);
+
+	for (int y = 0; y < atlas_surface->h; ++y)
+	{
+		const Uint8* row = static_cast<const Uint8*>(atlas_surface->pixels) + y * atlas_surface->pitch;
+
+		for (int x = 0; x < atlas_surface->w; ++x)
+		{
+			coverage_[y * coverage_width_ + x] = row[x * 4 + 3];
+		}
+	}
+
+	if (renderer == nullptr)
+	{
+		SDL_FreeSurface(atlas_surface);
+		return true;
+	}
+
+	const bool loaded = texture_->LoadFromSurface(renderer, atlas_surface);
+	SDL_FreeSurface(atlas_surface);
+
+	return loaded;
+}
+
+void GlyphAtlas::Free()
+{
+	texture_->FreeTexture();
+	coverage_.clear();
+	coverage_width_ = 0;
+}
+
+void GlyphAtlas::Layout(const char* text, TextLayout& layout, float scale) const
+{
+	layout.quads.clear();
+	layout.height = static_cast<int>(line_height_ * scale);
+
+	int pen_x = 0;
+
+	for (const char* c = text; *c != '\0'; ++c)
+	{
+		int index = static_cast<unsigned char>(*c) - first_glyph;
+
+		if (index < 0 || index >= glyph_count)
+		{
+			index = '?' - first_glyph;
+		}
+
+		const SDL_Rect& source = glyphs_[index];
+
+		if (source.w > 0 && source.h > 0)
+		{
+			const SDL_Rect destination = 
+			{
+				static_cast<int>((pen_x + offsets_[index]) * scale), 
+				0, 
+				static_cast<int>(source.w * scale), 
+				static_cast<int>(source.h * scale)
+			};
+
+			layout.quads.push_back({ source, destination });
+		}
+
+		pen_x += advances_[index];
+	}
+
+	layout.width = static_cast<int>(pen_x * scale);
+}
+
+void GlyphAtlas::Render(DrawBuffer* draw_buffer, const TextLayout& layout, int x, int y, const SDL_Color& color) const
+{
+	for (const GlyphQuad& quad : layout.quads)
+	{
+		const SDL_Rect destination = { x + quad.destination.x, y + quad.destination.y, quad.destination.w, quad.destination.h };
+		draw_buffer->CopyTexture(DrawLayer::HUD, texture_->texture_, &quad.source, destination, color);
+	}
+}
+
+const std::vector<std::uint8_t>& GlyphAtlas::GetCoverage() const
+{
+	return coverage_;
+}
+
+int GlyphAtlas::GetCoverageWidth() const
+{
+	return coverage_width_;
+}
+
+HudCounter::HudCounter(const char* label) : label_(label), layout_{ {}, 0, 0 }, value_(0), laid_out_(false)
+{
+}
+
+const TextLayout& HudCounter::Update(const GlyphAtlas& atlas, int value)
+{
+	if (laid_out_ && value == value_)
+	{
+		return layout_;
+	}
+
+	value_ = value;
+	laid_out_ = true;
+
+	text_ = label_ + std::to_string(value_);
+	atlas.Layout(text_.c_str(), layout_);
+
+	return layout_;
+}
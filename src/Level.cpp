@@ -2,24 +2,152 @@
 #include "Game.hpp"
 #include "Tile.hpp"
 #include "Constants.hpp"
+#include "Trace.hpp"
+#include "MappedFile.hpp"
+#include "ByteOrder.hpp"
+#include "Zobrist.hpp"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include <mutex>
+#include <utility>
 #include <vector>
 #include <cmath>
 
+namespace
+{
+	// Compiled level layout, little-endian:
+	//   "PMLV", u16 version, u16 width, u16 height, u16 spawn count, u32 reserved, u64 level hash,
+	//   u32 spawn tile per SpawnPoint, u8 TileType per tile (padded to 8 bytes),
+	//   then the pellet bitset and energizer bitset (u64 words).
+	// Neighbours follow from the board's size, so they are not stored.
+	constexpr char compiled_magic[4] = { 'P', 'M', 'L', 'V' };
+	constexpr std::uint16_t compiled_version = 3;
+	constexpr std::size_t compiled_header_size = 24;
+
+	// Pixel positions of the spawn tiles in the original maze, in SpawnPoint order.
+	constexpr SDL_Point default_spawns[] = { { 416, 736 }, { 352, 416 }, { 352, 480 }, { 512, 416 }, { 512, 480 }, { 416, 352 } };
+
+	struct TileColor
+	{
+		Uint8 r;
+		Uint8 g;
+		Uint8 b;
+		TileType type;
+		bool pellet;
+		bool energizer;
+	};
+
+	// FNV-1a over the layout, so recordings can tell whether they were made on this level.
+	std::uint64_t HashLayout(int width, int height, const std::vector<std::uint8_t>& tiles, const Bitset& pellets, const Bitset& energizers)
+	{
+		std::uint64_t hash = 0xcbf29ce484222325ULL;
+
+		for (const int value : { width, height })
+		{
+			hash = (hash ^ static_cast<std::uint64_t>(value)) * 0x100000001b3ULL;
+		}
+
+		for (std::size_t i = 0; i < tiles.size(); ++i)
+		{
+			const int value = tiles[i] | (pellets.Test(i) << 4) | (energizers.Test(i) << 5);
+			hash = (hash ^ static_cast<std::uint64_t>(value)) * 0x100000001b3ULL;
+		}
+
+		return hash;
+	}
+
+	// Level image colours and the tiles they stand for; any other colour is left EMPTY.
+	constexpr TileColor tile_colors[] = 
+	{
+		{ 0x00, 0x00, 0x00, TileType::EMPTY, false, false }, 
+		{ 0xff, 0x64, 0x00, TileType::GHOST_GATE, false, false }, 
+		{ 0xff, 0xff, 0xff, TileType::GHOST_HOME, false, false }, 
+		{ 0x00, 0x00, 0xaa, TileType::WALL, false, false }, 
+		{ 0xff, 0x00, 0x00, TileType::PATH, false, true }, 
+		{ 0xff, 0xaf, 0xb9, TileType::PATH, true, false }, 
+		{ 0x64, 0x64, 0x64, TileType::PATH, false, false }, 
+		{ 0x00, 0xff, 0xff, TileType::GHOST_CROSSROAD, true, false }, 
+		{ 0xff, 0xff, 0x00, TileType::GHOST_CROSSROAD, false, false }
+	};
+
+	// Open-addressed map from a pixel value in the image's own format to its tile_colors entry, so
+	// classifying a pixel is one multiplicative hash and usually a single compare.
+	class TileColorTable
+	{
+	private:
+		static constexpr int bits = 5;
+
+		std::array<Uint32, 1 << bits> keys_;
+		std::array<int, 1 << bits> entries_;
+		Uint32 mask_;
+
+		static int Slot(Uint32 pixel)
+		{
+			return static_cast<int>((pixel * 0x9e3779b1u) >> (32 - bits));
+		}
+
+	public:
+		explicit TileColorTable(const SDL_PixelFormat* format) : 
+			keys_{}, 
+			mask_(format->Rmask | format->Gmask | format->Bmask | format->Amask)
+		{
+			entries_.fill(-1);
+
+			for (int i = 0; i < static_cast<int>(std::size(tile_colors)); ++i)
+			{
+				const Uint32 key = SDL_MapRGBA(format, tile_colors[i].r, tile_colors[i].g, tile_colors[i].b, 0xff) & mask_;
+				int slot = Slot(key);
+
+				while (entries_[slot] != -1)
+				{
+					slot = (slot + 1) & ((1 << bits) - 1);
+				}
+
+				keys_[slot] = key;
+				entries_[slot] = i;
+			}
+		}
+
+		// Returns the tile_colors index for the pixel, or -1 for a colour that is not in the scheme.
+		int Find(Uint32 pixel) const
+		{
+			pixel &= mask_;
+
+			for (int slot = Slot(pixel); entries_[slot] != -1; slot = (slot + 1) & ((1 << bits) - 1))
+			{
+				if (keys_[slot] == pixel)
+				{
+					return entries_[slot];
+				}
+			}
+
+			return -1;
+		}
+	};
+}
+
 Level::Level(Game* game) : 
 	game_(game), 
-	surface_pixels_(nullptr), 
-	pixels_(nullptr), 
+	maze_texture_(std::make_unique<Texture>()), 
 	pixel_width_(0), 
 	pixel_height_(0), 
 	pixel_count_(0), 
 	tile_size_(32), 
-	pellet_count_(0), 
-	energizer_count_(0)
+	flow_field_(std::make_unique<FlowField>()), 
+	occupancy_(std::make_unique<OccupancyGrid>()), 
+	collectibles_total_(0), 
+	collectibles_left_(0), 
+	hash_(0), 
+	pellet_hash_(0), 
+	spawns_{}
 {	
 }
 
@@ -32,231 +160,675 @@ void Level::HandleEvents()
 {
 
 }
-	
-void Level::Tick()
+
+void Level::Render(bool use_maze_texture)
 {
-	const int pellets_on_board = std::count_if(board_.begin(), board_.end(), [](const Tile& tile)
+	TRACE_ZONE("Level::Render");
+
+	// Only the tiles under the camera are drawn, so the cost follows the viewport, not the board.
+	const SDL_Rect tiles = game_->GetCamera()->GetVisibleTiles(tile_size_, GetPixelWidth(), GetPixelHeight());
+	const bool prerendered = use_maze_texture && maze_texture_->texture_ != nullptr;
+
+	if (prerendered)
 	{
-		return tile.pellet_spawned_;
-	});
+		const SDL_Rect visible = { tiles.x * tile_size_, tiles.y * tile_size_, tiles.w * tile_size_, tiles.h * tile_size_ };
+		game_->GetDrawBuffer()->CopyTexture(DrawLayer::MAZE, maze_texture_->texture_, &visible, visible);
+	}
 
-	const int energizers_on_board = std::count_if(board_.begin(), board_.end(), [](const Tile& tile)
+	for (int y = tiles.y; y < tiles.y + tiles.h; ++y)
 	{
-		return tile.energizer_spawned_;
-	});
+		for (int index = y * GetPixelWidth() + tiles.x; index < y * GetPixelWidth() + tiles.x + tiles.w; ++index)
+		{
+			if (!prerendered)
+			{
+				RenderStatic(index, game_->GetDrawBuffer());
+			}
+
+			RenderPellet(index);
+		}
+	}
+}
+
+void Level::RenderStatic(int index, DrawBuffer* draw_buffer)
+{
+	const SDL_Rect rect = GetTileRect(index);
 
-	if (pellets_on_board == 0 && energizers_on_board == 0)
+	if (GetTileType(index) == TileType::GHOST_GATE)
 	{
-		game_->level_completed_ = true;
+		draw_buffer->FillRect(DrawLayer::MAZE, rect, 0xff, 0xaf, 0xb9);
+	}
+	else if (GetTileType(index) == TileType::WALL)
+	{
+		draw_buffer->FillRect(DrawLayer::MAZE, rect, 0x00, 0x00, 0xaa);
+	}
+	else
+	{
+		draw_buffer->FillRect(DrawLayer::MAZE, rect, 0x00, 0x00, 0x00);
 	}
 }
 
-void Level::Render()
+void Level::RenderPellet(int index)
 {
-	std::for_each(board_.begin(), board_.end(), [](const Tile& tile)
+	if (HasPellet(index) || HasEnergizer(index))
 	{
-		tile.Render();
-	});
+		const int pellet_size = pellets_.Test(index) ? 6 : 18;
+		const SDL_Rect rect = GetTileRect(index);
+		const SDL_Rect pellet = { rect.x + (tile_size_ / 2) - (pellet_size / 2), rect.y + (tile_size_ / 2) - (pellet_size / 2), pellet_size, pellet_size };
+
+		game_->GetDrawBuffer()->FillRect(DrawLayer::PELLETS, pellet, 0xff, 0xaf, 0xb9);
+	}
 }
 
 bool Level::Load(const char* path)
 {
-	Free();
+	SDL_Surface* loaded_surface = nullptr;
 
-	surface_pixels_ = IMG_Load(path);
+	{
+		// SDL_image initializes its decoders lazily and not thread-safely.
+		static std::mutex load_mutex;
+		std::lock_guard<std::mutex> lock(load_mutex);
+		loaded_surface = IMG_Load(path);
+	}
 
-	if (surface_pixels_ == nullptr)
+	if (loaded_surface == nullptr)
 	{
 		printf("Unable to load image %s! SDL_image Error: %s\n", path, IMG_GetError());
 		return false;
 	}
 
-	surface_pixels_ = SDL_ConvertSurfaceFormat(surface_pixels_, SDL_GetWindowPixelFormat(game_->window_), 0);
+	const bool loaded = Load(loaded_surface);
+	SDL_FreeSurface(loaded_surface);
+
+	return loaded;
+}
+
+bool Level::Load(SDL_Surface* surface)
+{
+	if (surface->w > constants::max_level_size || surface->h > constants::max_level_size)
+	{
+		printf("Level image is %dx%d, larger than the %dx%d limit!\n", surface->w, surface->h, constants::max_level_size, constants::max_level_size);
+		return false;
+	}
+
+	// Any 32-bit image is classified in its own format; only other depths and RLE surfaces pay for
+	// a converted copy. The level image is never drawn, so it does not need the window's format.
+	SDL_Surface* converted_surface = nullptr;
+
+	if (surface->format->BytesPerPixel != 4 || SDL_MUSTLOCK(surface))
+	{
+		converted_surface = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA8888, 0);
+
+		if (converted_surface == nullptr)
+		{
+			printf("Unable to convert level image! SDL Error: %s\n", SDL_GetError());
+			return false;
+		}
+
+		surface = converted_surface;
+	}
 
-	pixel_width_ = surface_pixels_->w;
-	pixel_height_ = surface_pixels_->h;
+	pixel_width_ = surface->w;
+	pixel_height_ = surface->h;
 	pixel_count_ = pixel_width_ * pixel_height_;
 
+	tiles_.assign(GetPixelCount(), static_cast<std::uint8_t>(TileType::EMPTY));
+	pellets_.Resize(GetPixelCount());
+	energizers_.Resize(GetPixelCount());
+
+	const TileColorTable color_table(surface->format);
+
+	for (int y = 0; y < pixel_height_; ++y)
+	{
+		const Uint32* pixels = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(surface->pixels) + static_cast<std::size_t>(y) * surface->pitch);
+		const int row = y * pixel_width_;
+
+		// Mazes are mostly runs of wall and pellet, so the previous pixel's entry is tried first.
+		Uint32 previous_pixel = pixels[0];
+		int entry = color_table.Find(previous_pixel);
+
+		for (int x = 0; x < pixel_width_; ++x)
+		{
+			if (pixels[x] != previous_pixel)
+			{
+				previous_pixel = pixels[x];
+				entry = color_table.Find(previous_pixel);
+			}
+
+			if (entry == -1)
+			{
+				continue;
+			}
+
+			tiles_[row + x] = static_cast<std::uint8_t>(tile_colors[entry].type);
+
+			if (tile_colors[entry].pellet)
+			{
+				pellets_.Set(row + x);
+			}
+			else if (tile_colors[entry].energizer)
+			{
+				energizers_.Set(row + x);
+			}
+		}
+	}
+
+	if (converted_surface != nullptr)
+	{
+		SDL_FreeSurface(converted_surface);
+	}
+
+	BuildNeighborTable();
+	PlaceSpawns();
+
 	return true;
 }
 
-void Level::Initialize(const char* path)
+void Level::PlaceSpawns()
 {
-	Load(path);
+	// Level images carry no spawn markers. The original maze's spawn tiles are scaled to this
+	// level's size and moved to the closest open tile, which leaves them as they were on that maze.
+	const int default_width = constants::board_width / tile_size_;
+	const int default_height = constants::board_height / tile_size_;
 
-	board_.resize(GetPixelCount(), game_);
+	for (int i = 0; i < static_cast<int>(SpawnPoint::COUNT); ++i)
+	{
+		const int x = static_cast<int>(static_cast<long long>(default_spawns[i].x / tile_size_) * GetPixelWidth() / default_width);
+		const int y = static_cast<int>(static_cast<long long>(default_spawns[i].y / tile_size_) * GetPixelHeight() / default_height);
 
-	const Uint32 empty_color = SDL_MapRGBA(surface_pixels_->format, 0x00, 0x00, 0x00, 0xff);
-	const Uint32 ghost_gate_color = SDL_MapRGBA(surface_pixels_->format, 0xff, 0x64, 0x00, 0xff);
-	const Uint32 ghost_home_color = SDL_MapRGBA(surface_pixels_->format, 0xff, 0xff, 0xff, 0xff);
-	const Uint32 wall_color = SDL_MapRGBA(surface_pixels_->format, 0x00, 0x00, 0xaa, 0xff);
-	const Uint32 energizer_color = SDL_MapRGBA(surface_pixels_->format, 0xff, 0x00, 0x00, 0xff);
-	const Uint32 pellet_color = SDL_MapRGBA(surface_pixels_->format, 0xff, 0xaf, 0xb9, 0xff);
-	const Uint32 empty_path_color = SDL_MapRGBA(surface_pixels_->format, 0x64, 0x64, 0x64, 0xff);
-	const Uint32 ghost_crossroad_pellet_color = SDL_MapRGBA(surface_pixels_->format, 0x00, 0xff, 0xff, 0xff);
-	const Uint32 ghost_crossroad_empty_color = SDL_MapRGBA(surface_pixels_->format, 0xff, 0xff, 0x00, 0xff);
+		spawns_[i] = FindOpenTile(y * GetPixelWidth() + x);
+	}
+}
 
-	const Uint32* pixels = GetPixels32();
+int Level::FindOpenTile(int index)
+{
+	if (!IsWall(index))
+	{
+		return index;
+	}
 
-	int tile_x = 0;
-	int tile_y = 0;
+	std::vector<bool> visited(tiles_.size(), false);
+	std::vector<int> queue = { index };
+	visited[index] = true;
 
-	for (int i = 0; i < GetPixelCount(); ++i)
+	for (std::size_t head = 0; head < queue.size(); ++head)
 	{
-		if (pixels[i] == empty_color)
-		{
-			board_[i].type_ = TileType::EMPTY;
-		}
-		else if (pixels[i] == ghost_gate_color)
-		{
-			board_[i].type_ = TileType::GHOST_GATE;
-		}
-		else if (pixels[i] == ghost_home_color)
-		{
-			board_[i].type_ = TileType::GHOST_HOME;
-		}
-		else if (pixels[i] == wall_color)
-		{
-			board_[i].type_ = TileType::WALL;
-		}
-		else if (pixels[i] == energizer_color)
-		{
-			board_[i].type_ = TileType::PATH;
-			board_[i].energizer_ = true;
-			board_[i].energizer_spawned_ = true;
-			++energizer_count_;
-		}
-		else if (pixels[i] == pellet_color)
-		{
-			board_[i].type_ = TileType::PATH;
-			board_[i].pellet_ = true;
-			board_[i].pellet_spawned_ = true;
-			++pellet_count_;
-		}
-		else if (pixels[i] == empty_path_color)
+		for (int i = 0; i < 4; ++i)
 		{
-			board_[i].type_ = TileType::PATH;
+			const int neighbor = GetNeighbor(queue[head], static_cast<Direction>(i));
+
+			if (visited[neighbor])
+			{
+				continue;
+			}
+
+			if (!IsWall(neighbor))
+			{
+				return neighbor;
+			}
+
+			visited[neighbor] = true;
+			queue.push_back(neighbor);
 		}
-		else if (pixels[i] == ghost_crossroad_pellet_color)
+	}
+
+	// An all-wall level has nowhere better to put anything.
+	return index;
+}
+
+bool Level::LoadCompiled(const char* path)
+{
+	MappedFile file;
+
+	if (!file.Open(path))
+	{
+		return false;
+	}
+
+	const std::uint8_t* data = file.GetData();
+	const std::size_t size = file.GetSize();
+
+	if (size < compiled_header_size || std::memcmp(data, compiled_magic, sizeof(compiled_magic)) != 0 || ReadLittleEndian(data + 4, 2) != compiled_version)
+	{
+		printf("%s is not a compiled level!\n", path);
+		return false;
+	}
+
+	const int width = static_cast<int>(ReadLittleEndian(data + 6, 2));
+	const int height = static_cast<int>(ReadLittleEndian(data + 8, 2));
+	const int spawn_count = static_cast<int>(ReadLittleEndian(data + 10, 2));
+	const std::size_t tile_count = static_cast<std::size_t>(width) * height;
+	const std::size_t bitset_bytes = (tile_count + 63) / 64 * 8;
+	const std::size_t types_offset = compiled_header_size + static_cast<std::size_t>(spawn_count) * 4;
+	const std::size_t pellets_offset = types_offset + (tile_count + 7) / 8 * 8;
+	const std::size_t energizers_offset = pellets_offset + bitset_bytes;
+
+	if (spawn_count != static_cast<int>(SpawnPoint::COUNT) || tile_count == 0 || width > constants::max_level_size || height > constants::max_level_size || size != energizers_offset + bitset_bytes)
+	{
+		printf("Compiled level %s is truncated or malformed!\n", path);
+		return false;
+	}
+
+	// Everything is read and checked on the side, so a bad file leaves the current level as it was.
+	std::array<int, static_cast<int>(SpawnPoint::COUNT)> spawns;
+
+	for (int i = 0; i < spawn_count; ++i)
+	{
+		spawns[i] = static_cast<int>(ReadLittleEndian(data + compiled_header_size + i * 4, 4));
+	}
+
+	// Tiles and bitsets are stored the way Level keeps them, so they load as straight copies.
+	std::vector<std::uint8_t> tiles(data + types_offset, data + types_offset + tile_count);
+	Bitset pellets;
+	Bitset energizers;
+	pellets.Resize(tile_count);
+	energizers.Resize(tile_count);
+
+	for (std::size_t i = 0; i < pellets.GetWordCount(); ++i)
+	{
+		pellets.GetWords()[i] = ReadLittleEndian(data + pellets_offset + i * 8, 8);
+		energizers.GetWords()[i] = ReadLittleEndian(data + energizers_offset + i * 8, 8);
+	}
+
+	// The hash covers the tiles; the spawns and padding bits it does not cover still have to be sane.
+	const auto out_of_range = [tile_count](int index)
+	{
+		return index < 0 || static_cast<std::size_t>(index) >= tile_count;
+	};
+
+	const auto bad_type = [](std::uint8_t type)
+	{
+		return type > static_cast<std::uint8_t>(TileType::GHOST_CROSSROAD);
+	};
+
+	const std::uint64_t padding = tile_count % 64 == 0 ? 0 : ~std::uint64_t{ 0 } << (tile_count % 64);
+	const std::size_t last_word = pellets.GetWordCount() - 1;
+
+	if (std::any_of(tiles.begin(), tiles.end(), bad_type) || (pellets.GetWords()[last_word] & padding) != 0 || (energizers.GetWords()[last_word] & padding) != 0)
+	{
+		printf("Compiled level %s is corrupt!\n", path);
+		return false;
+	}
+
+	if (ReadLittleEndian(data + 16, 8) != HashLayout(width, height, tiles, pellets, energizers) || std::any_of(spawns.begin(), spawns.end(), out_of_range))
+	{
+		printf("Compiled level %s is corrupt!\n", path);
+		return false;
+	}
+
+	pixel_width_ = width;
+	pixel_height_ = height;
+	pixel_count_ = static_cast<int>(tile_count);
+	spawns_ = spawns;
+	tiles_ = std::move(tiles);
+	pellets_ = std::move(pellets);
+	energizers_ = std::move(energizers);
+
+	BuildNeighborTable();
+
+	return true;
+}
+
+bool Level::Save(const char* path)
+{
+	const std::size_t tile_count = tiles_.size();
+	const std::size_t bitset_bytes = (tile_count + 63) / 64 * 8;
+	const std::size_t types_offset = compiled_header_size + static_cast<std::size_t>(SpawnPoint::COUNT) * 4;
+	const std::size_t pellets_offset = types_offset + (tile_count + 7) / 8 * 8;
+	const std::size_t energizers_offset = pellets_offset + bitset_bytes;
+
+	std::vector<std::uint8_t> bytes(energizers_offset + bitset_bytes, 0);
+
+	std::memcpy(bytes.data(), compiled_magic, sizeof(compiled_magic));
+	WriteLittleEndian(&bytes[4], compiled_version, 2);
+	WriteLittleEndian(&bytes[6], static_cast<std::uint64_t>(GetPixelWidth()), 2);
+	WriteLittleEndian(&bytes[8], static_cast<std::uint64_t>(GetPixelHeight()), 2);
+	WriteLittleEndian(&bytes[10], static_cast<std::uint64_t>(SpawnPoint::COUNT), 2);
+	WriteLittleEndian(&bytes[16], hash_, 8);
+
+	for (int i = 0; i < static_cast<int>(SpawnPoint::COUNT); ++i)
+	{
+		WriteLittleEndian(&bytes[compiled_header_size + i * 4], static_cast<std::uint32_t>(spawns_[i]), 4);
+	}
+
+	std::memcpy(&bytes[types_offset], tiles_.data(), tile_count);
+
+	for (std::size_t i = 0; i < pellets_.GetWordCount(); ++i)
+	{
+		WriteLittleEndian(&bytes[pellets_offset + i * 8], pellets_.GetWords()[i], 8);
+		WriteLittleEndian(&bytes[energizers_offset + i * 8], energizers_.GetWords()[i], 8);
+	}
+
+	FILE* file = std::fopen(path, "wb");
+
+	if (file == nullptr)
+	{
+		printf("Unable to write compiled level %s!\n", path);
+		return false;
+	}
+
+	const bool written = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+	std::fclose(file);
+
+	return written;
+}
+
+bool Level::Initialize(const char* path)
+{
+	TRACE_ZONE("Level::Initialize");
+
+	const std::size_t length = std::strlen(path);
+	const bool compiled = length >= 4 && std::strcmp(path + length - 4, ".lvl") == 0;
+
+	if (!(compiled ? LoadCompiled(path) : Load(path)))
+	{
+		return false;
+	}
+
+	Build();
+
+	return true;
+}
+
+bool Level::Initialize(SDL_Surface* surface)
+{
+	TRACE_ZONE("Level::Initialize");
+
+	if (!Load(surface))
+	{
+		return false;
+	}
+
+	Build();
+
+	return true;
+}
+
+void Level::Build()
+{
+	collectibles_total_ = pellets_.Count() + energizers_.Count();
+	hash_ = ComputeHash();
+	pellet_hash_ = 0;
+
+	for (int i = 0; i < GetTileCount(); ++i)
+	{
+		if (pellets_.Test(i))
 		{
-			board_[i].type_ = TileType::GHOST_CROSSROAD;
-			board_[i].pellet_ = true;
-			board_[i].pellet_spawned_ = true;
-			++pellet_count_;
+			pellet_hash_ ^= zobrist::Key(zobrist::Feature::PELLET, 0, i);
 		}
-		else if (pixels[i] == ghost_crossroad_empty_color)
+
+		if (energizers_.Test(i))
 		{
-			board_[i].type_ = TileType::GHOST_CROSSROAD;
+			pellet_hash_ ^= zobrist::Key(zobrist::Feature::ENERGIZER, 0, i);
 		}
+	}
 
-		board_[i].tile_size_ = tile_size_;
-		board_[i].rect_.x = tile_x;
-		board_[i].rect_.y = tile_y;
-		board_[i].rect_.w = tile_size_;
-		board_[i].rect_.h = board_[i].rect_.w;
+	Reset();
 
-		tile_x += tile_size_;
+	flow_field_->Clear();
+	occupancy_->Resize(pixel_width_, pixel_height_);
+	BuildRouteTable();
+	BuildMazeTexture();
+}
 
-		if ((i + 1) % GetPixelWidth() == 0)
-		{
-			tile_x = 0;
-			tile_y += tile_size_;
-		}
-	}
+std::uint64_t Level::ComputeHash()
+{
+	return HashLayout(GetPixelWidth(), GetPixelHeight(), tiles_, pellets_, energizers_);
 }
 
 void Level::Free()
 {
-	if (surface_pixels_ != nullptr)
+	maze_texture_->FreeTexture();
+}
+
+void Level::Reset()
+{
+	pellets_present_ = pellets_;
+	energizers_present_ = energizers_;
+	collectibles_left_ = collectibles_total_;
+
+	// Nothing to eat means nothing left to eat: no EatPellet will ever complete such a level.
+	if (collectibles_total_ == 0)
 	{
-		SDL_FreeSurface(surface_pixels_);
-		surface_pixels_ = nullptr;
+		game_->level_completed_ = true;
 	}
 }
 
-void Level::Reset()
+void Level::Snapshot(GameState& state) const
+{
+	std::memcpy(state.pellets, pellets_present_.GetWords(), pellets_present_.GetWordCount() * sizeof(std::uint64_t));
+	std::memcpy(state.energizers, energizers_present_.GetWords(), energizers_present_.GetWordCount() * sizeof(std::uint64_t));
+	state.collectibles_left = collectibles_left_;
+}
+
+void Level::Restore(const GameState& state)
+{
+	std::memcpy(pellets_present_.GetWords(), state.pellets, pellets_present_.GetWordCount() * sizeof(std::uint64_t));
+	std::memcpy(energizers_present_.GetWords(), state.energizers, energizers_present_.GetWordCount() * sizeof(std::uint64_t));
+	collectibles_left_ = state.collectibles_left;
+}
+
+void Level::EatPellet(int index)
+{
+	pellets_present_.Clear(index);
+
+	if (--collectibles_left_ == 0)
+	{
+		game_->level_completed_ = true;
+	}
+}
+
+void Level::EatEnergizer(int index)
+{
+	energizers_present_.Clear(index);
+
+	if (--collectibles_left_ == 0)
+	{
+		game_->level_completed_ = true;
+	}
+}
+
+bool Level::BuildMazeTexture()
 {
-	for (Tile& tile : board_)
+	TRACE_ZONE("Level::BuildMazeTexture");
+
+	SDL_Renderer* renderer = game_->renderer_;
+
+	maze_texture_->FreeTexture();
+
+	if (renderer == nullptr || !SDL_RenderTargetSupported(renderer))
+	{
+		return false;
+	}
+
+	// Boards too big for one texture are drawn tile by tile, which the camera keeps to the viewport.
+	SDL_RendererInfo info;
+	const int max_size = SDL_GetRendererInfo(renderer, &info) == 0 && info.max_texture_width > 0 ? std::min({ info.max_texture_width, info.max_texture_height, constants::max_maze_texture_size }) : constants::max_maze_texture_size;
+
+	if (GetBoardWidth() > max_size || GetBoardHeight() > max_size)
+	{
+		return false;
+	}
+
+	if (!maze_texture_->CreateTarget(renderer, GetBoardWidth(), GetBoardHeight()))
 	{
-		if (tile.pellet_)
+		return false;
+	}
+
+	// Walls and the ghost gate never change, so they are drawn once; pellets go on top per frame.
+	SDL_Texture* previous_target = SDL_GetRenderTarget(renderer);
+	SDL_SetRenderTarget(renderer, maze_texture_->texture_);
+
+	SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0xff);
+	SDL_RenderClear(renderer);
+
+	// A buffer of its own keeps these draws out of the frame's buffer and its stats.
+	DrawBuffer draw_buffer;
+
+	for (int i = 0; i < GetTileCount(); ++i)
+	{
+		// Every other tile type is plain black, which the clear already covers.
+		if (GetTileType(i) == TileType::WALL || GetTileType(i) == TileType::GHOST_GATE)
 		{
-			tile.pellet_spawned_ = true;
+			RenderStatic(i, &draw_buffer);
 		}
-		else if (tile.energizer_)
+	}
+
+	draw_buffer.Flush(renderer);
+
+	SDL_SetRenderTarget(renderer, previous_target);
+
+	return true;
+}
+
+void Level::BuildNeighborTable()
+{
+	// Past the limit the table would dwarf the board itself, and the index arithmetic is cheap.
+	if (GetPixelCount() > constants::max_neighbor_table_tiles)
+	{
+		std::vector<int>().swap(neighbors_);
+		return;
+	}
+
+	neighbors_.clear();
+	neighbors_.reserve(static_cast<std::size_t>(GetPixelCount()) * 4);
+
+	for (int i = 0; i < GetPixelCount(); ++i)
+	{
+		const std::array<int, 4> neighbors = ComputeNeighbors(i);
+		neighbors_.insert(neighbors_.end(), neighbors.begin(), neighbors.end());
+	}
+}
+
+void Level::BuildRouteTable()
+{
+	// Levels with the same layout share one table, so only the first game on a level builds it.
+	routes_ = RouteTable::Get(this);
+}
+
+void Level::UpdateFlowField(int target)
+{
+	flow_field_->Update(this, target);
+}
+
+Direction Level::GetStepDirection(int source, int target) const
+{
+	const std::array<int, 4> neighbors = GetNeighbors(source);
+
+	for (int i = 0; i < 4; ++i)
+	{
+		if (neighbors[i] == target)
 		{
-			tile.energizer_spawned_ = true;
+			return static_cast<Direction>(i);
 		}
 	}
+
+	return Direction::NONE;
 }
 
-int Level::TileDistance(const Tile& source, const Tile& target)
+bool Level::CanGhostStep(int source, Direction direction)
 {
-	const int x_distance = std::abs(target.rect_.x - source.rect_.x) / tile_size_;
-	const int y_distance = std::abs(target.rect_.y - source.rect_.y) / tile_size_;
+	const int target = GetNeighbor(source, direction);
+
+	if (target == -1 || IsWall(target))
+	{
+		return false;
+	}
+
+	if (GetTileType(source) != TileType::GHOST_HOME && GetTileType(target) == TileType::GHOST_GATE)
+	{
+		return false;
+	}
+
+	if (GetTileType(source) == TileType::GHOST_CROSSROAD && direction == Direction::UP)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+int Level::TileDistance(int source, int target)
+{
+	const int width = GetPixelWidth();
+	const int x_distance = std::abs(target % width - source % width);
+	const int y_distance = std::abs(target / width - source / width);
 
 	return x_distance + y_distance;
 }
 
-Tile* Level::GetTile(int x, int y)
+int Level::GetTileIndex(int x, int y)
 {
-	if (x < 0 || y < 0 || x >= constants::board_width || y >= constants::board_height)
+	if (x < 0 || y < 0 || x >= GetBoardWidth() || y >= GetBoardHeight())
 	{
-		return nullptr;
+		return -1;
 	}
 
-	const int index = (y / tile_size_) * GetPixelWidth() + (x / tile_size_);
-	
-	if (index < 0 || index >= static_cast<int>(board_.size()))
-	{
-		return nullptr;
-	}
-	
-	return &board_[index];
+	return (y / tile_size_) * GetPixelWidth() + (x / tile_size_);
+}
+
+int Level::GetTileCount()
+{
+	return static_cast<int>(tiles_.size());
+}
+
+std::uint64_t Level::GetHash() const
+{
+	return hash_;
+}
+
+std::uint64_t Level::GetPelletHash() const
+{
+	return pellet_hash_;
 }
 
-Tile* Level::GetUpperTile(int x, int y)
+int Level::GetPelletCount() const
+{
+	return pellets_present_.Count();
+}
+
+int Level::GetEnergizerCount() const
+{
+	return energizers_present_.Count();
+}
+
+int Level::GetUpperTile(int x, int y)
 {
 	if (y < tile_size_ && y >= 0)
 	{
-		y += constants::board_height;
+		y += GetBoardHeight();
 	}
 
-	return GetTile(x, y - tile_size_);
+	return GetTileIndex(x, y - tile_size_);
 }
 	
-Tile* Level::GetLowerTile(int x, int y)
+int Level::GetLowerTile(int x, int y)
 {
-	if (y >= constants::board_height - tile_size_ && y < constants::board_height)
+	if (y >= GetBoardHeight() - tile_size_ && y < GetBoardHeight())
 	{
-		y -= constants::board_height;
+		y -= GetBoardHeight();
 	}
 
-	return GetTile(x, y + tile_size_);
+	return GetTileIndex(x, y + tile_size_);
 }
 
-Tile* Level::GetLeftTile(int x, int y)
+int Level::GetLeftTile(int x, int y)
 {
 	if (x < tile_size_ && x >= 0)
 	{
-		x += constants::board_width;
+		x += GetBoardWidth();
 	}
 
-	return GetTile(x - tile_size_, y);
+	return GetTileIndex(x - tile_size_, y);
 }
 
-Tile* Level::GetRightTile(int x, int y)
+int Level::GetRightTile(int x, int y)
 {
-	if (x >= constants::board_width - tile_size_ && x < constants::board_width)
+	if (x >= GetBoardWidth() - tile_size_ && x < GetBoardWidth())
 	{
-		x -= constants::board_width;
+		x -= GetBoardWidth();
 	}
 
-	return GetTile(x + tile_size_, y);
-}
-
-std::vector<Tile*> Level::GetNeighborTiles(int x, int y)
-{
-	return { GetLeftTile(x, y), GetRightTile(x, y), GetUpperTile(x, y), GetLowerTile(x, y) };
+	return GetTileIndex(x + tile_size_, y);
 }
 
 int Level::GetPixelWidth()
@@ -274,31 +846,22 @@ int Level::GetPixelCount()
 	return pixel_count_;
 }
 
-SDL_Surface* Level::GetPixelSurface()
+int Level::GetBoardWidth()
 {
-	return surface_pixels_;
+	return pixel_width_ * tile_size_;
 }
 
-Uint32* Level::GetPixels32()
+int Level::GetBoardHeight()
 {
-	pixels_ = nullptr;
-
-	if (surface_pixels_ != nullptr)
-	{
-		pixels_ = static_cast<Uint32*>(surface_pixels_->pixels);
-	}
-
-	return pixels_;
+	return pixel_height_ * tile_size_;
 }
 
-Uint32 Level::GetPitch32()
+int Level::GetTileSize()
 {
-	Uint32 pitch = 0;
-
-	if (surface_pixels_ != nullptr)
-	{
-		pitch = surface_pixels_->pitch / 4;
-	}
+	return tile_size_;
+}
 
-	return pitch;
-}
\ No newline at end of file
+int Level::GetSpawn(SpawnPoint spawn)
+{
+	return spawns_[static_cast<int>(spawn)];
+}
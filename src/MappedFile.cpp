@@ -0,0 +1,98 @@
+#include "MappedFile.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : data_(nullptr), size_(0), mapped_(false)
+{
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const char* path)
+{
+	Close();
+
+#if !defined(_WIN32)
+	const int fd = open(path, O_RDONLY);
+
+	if (fd == -1)
+	{
+		printf("Unable to open %s!\n", path);
+		return false;
+	}
+
+	struct stat file_stat;
+
+	if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0)
+	{
+		void* data = mmap(nullptr, static_cast<std::size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (data != MAP_FAILED)
+		{
+			madvise(data, static_cast<std::size_t>(file_stat.st_size), MADV_SEQUENTIAL);
+
+			data_ = static_cast<const std::uint8_t*>(data);
+			size_ = static_cast<std::size_t>(file_stat.st_size);
+			mapped_ = true;
+		}
+	}
+
+	close(fd);
+
+	if (mapped_)
+	{
+		return true;
+	}
+#endif
+
+	std::ifstream file(path, std::ios::binary);
+
+	if (!file)
+	{
+		printf("Unable to open %s!\n", path);
+		return false;
+	}
+
+	buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	data_ = buffer_.data();
+	size_ = buffer_.size();
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+#if !defined(_WIN32)
+	if (mapped_)
+	{
+		munmap(const_cast<std::uint8_t*>(data_), size_);
+	}
+#endif
+
+	buffer_.clear();
+	data_ = nullptr;
+	size_ = 0;
+	mapped_ = false;
+}
+
+const std::uint8_t* MappedFile::GetData() const
+{
+	return data_;
+}
+
+std::size_t MappedFile::GetSize() const
+{
+	return size_;
+}
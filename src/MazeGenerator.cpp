@@ -0,0 +1,104 @@
+#include "MazeGenerator.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <utility>
+#include <vector>
+
+SDL_Surface* GenerateMaze(int width, int height, std::uint32_t seed)
+{
+	if (width < 3 || height < 3)
+	{
+		return nullptr;
+	}
+
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA8888);
+
+	if (surface == nullptr)
+	{
+		return nullptr;
+	}
+
+	const Uint32 wall_color = SDL_MapRGBA(surface->format, 0x00, 0x00, 0xaa, 0xff);
+	const Uint32 pellet_color = SDL_MapRGBA(surface->format, 0xff, 0xaf, 0xb9, 0xff);
+	const Uint32 energizer_color = SDL_MapRGBA(surface->format, 0xff, 0x00, 0x00, 0xff);
+
+	SDL_FillRect(surface, nullptr, wall_color);
+
+	// Writes straight into the surface, so a 4096x4096 maze needs no second copy of its pixels.
+	const auto cell = [surface](int x, int y) -> Uint32&
+	{
+		return reinterpret_cast<Uint32*>(static_cast<Uint8*>(surface->pixels) + static_cast<std::size_t>(y) * surface->pitch)[x];
+	};
+
+	std::mt19937 rng(seed);
+
+	const int cell_columns = (width - 1) / 2;
+	const int cell_rows = (height - 1) / 2;
+
+	std::vector<bool> visited(static_cast<std::size_t>(cell_columns) * cell_rows, false);
+	std::vector<std::pair<int, int>> stack = { { 0, 0 } };
+
+	visited[0] = true;
+	cell(1, 1) = pellet_color;
+
+	constexpr int offsets[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+
+	while (!stack.empty())
+	{
+		const auto [cx, cy] = stack.back();
+
+		int order[4] = { 0, 1, 2, 3 };
+		std::shuffle(std::begin(order), std::end(order), rng);
+
+		bool advanced = false;
+
+		for (const int i : order)
+		{
+			const int nx = cx + offsets[i][0];
+			const int ny = cy + offsets[i][1];
+
+			if (nx < 0 || ny < 0 || nx >= cell_columns || ny >= cell_rows || visited[ny * cell_columns + nx])
+			{
+				continue;
+			}
+
+			visited[ny * cell_columns + nx] = true;
+			cell(2 * cx + 1 + offsets[i][0], 2 * cy + 1 + offsets[i][1]) = pellet_color;
+			cell(2 * nx + 1, 2 * ny + 1) = pellet_color;
+			stack.push_back({ nx, ny });
+			advanced = true;
+			break;
+		}
+
+		if (!advanced)
+		{
+			stack.pop_back();
+		}
+	}
+
+	// A perfect maze has no loops for the player to escape through; open roughly one wall in ten.
+	std::uniform_int_distribution<int> chance(0, 9);
+
+	for (int y = 1; y < height - 1; ++y)
+	{
+		for (int x = 1; x < width - 1; ++x)
+		{
+			const bool between_columns = (x % 2 == 0) && (y % 2 == 1);
+			const bool between_rows = (x % 2 == 1) && (y % 2 == 0);
+
+			if ((between_columns || between_rows) && chance(rng) == 0)
+			{
+				cell(x, y) = pellet_color;
+			}
+		}
+	}
+
+	for (const auto& [x, y] : { std::pair<int, int>{ 1, 1 }, { width - 2, 1 }, { 1, height - 2 }, { width - 2, height - 2 } })
+	{
+		cell(x, y) = energizer_color;
+	}
+
+	return surface;
+}
@@ -0,0 +1,275 @@
+#include "Metrics.hpp"
+#include "Constants.hpp"
+
+#include <cstring>
+
+LatencyHistogram::LatencyHistogram() : 
+	counts_{}, 
+	count_(0), 
+	max_(0)
+{
+}
+
+int LatencyHistogram::GetBucket(std::uint64_t value)
+{
+	if (value < 2 * sub_bucket_count)
+	{
+		return static_cast<int>(value);
+	}
+
+#if defined(__GNUC__) || defined(__clang__)
+	const int magnitude = 63 - __builtin_clzll(value);
+#else
+	int magnitude = 63;
+
+	while ((value >> magnitude) == 0)
+	{
+		--magnitude;
+	}
+#endif
+
+	const int shift = magnitude - sub_bucket_bits;
+
+	return shift * sub_bucket_count + static_cast<int>(value >> shift);
+}
+
+std::uint64_t LatencyHistogram::GetBucketValue(int bucket)
+{
+	if (bucket < 2 * sub_bucket_count)
+	{
+		return static_cast<std::uint64_t>(bucket);
+	}
+
+	const int shift = bucket / sub_bucket_count - 1;
+	const std::uint64_t sub_bucket = static_cast<std::uint64_t>(bucket % sub_bucket_count + sub_bucket_count);
+
+	// Report the middle of the bucket's range.
+	return (sub_bucket << shift) + ((std::uint64_t(1) << shift) >> 1);
+}
+
+std::uint64_t LatencyHistogram::GetPercentile(double percentile) const
+{
+	if (count_ == 0)
+	{
+		return 0;
+	}
+
+	std::uint64_t target = static_cast<std::uint64_t>(percentile / 100.0 * static_cast<double>(count_) + 0.5);
+
+	if (target < 1)
+	{
+		target = 1;
+	}
+
+	std::uint64_t seen = 0;
+
+	for (int i = 0; i < bucket_count; ++i)
+	{
+		seen += counts_[i];
+
+		if (seen >= target)
+		{
+			const std::uint64_t value = GetBucketValue(i);
+			return value < max_ ? value : max_;
+		}
+	}
+
+	return max_;
+}
+
+std::uint64_t LatencyHistogram::GetCount() const
+{
+	return count_;
+}
+
+std::uint64_t LatencyHistogram::GetMax() const
+{
+	return max_;
+}
+
+void LatencyHistogram::Reset()
+{
+	counts_.fill(0);
+	count_ = 0;
+	max_ = 0;
+}
+
+Metrics::Metrics() : 
+	enabled_(false), 
+	frequency_(SDL_GetPerformanceFrequency()), 
+	interval_start_(0), 
+	first_start_(0), 
+	generation_(0), 
+	summaries_{}, 
+	file_(nullptr), 
+	json_(false)
+{
+}
+
+Metrics::~Metrics()
+{
+	Close();
+}
+
+void Metrics::SetEnabled(bool enabled)
+{
+	if (enabled && !enabled_)
+	{
+		interval_start_ = SDL_GetPerformanceCounter();
+
+		if (first_start_ == 0)
+		{
+			first_start_ = interval_start_;
+		}
+
+		for (LatencyHistogram& histogram : histograms_)
+		{
+			histogram.Reset();
+		}
+	}
+
+	enabled_ = enabled;
+}
+
+bool Metrics::Open(const char* path)
+{
+	Close();
+
+	file_ = std::fopen(path, "w");
+
+	if (file_ == nullptr)
+	{
+		printf("Unable to open metrics file %s!\n", path);
+		return false;
+	}
+
+	const std::size_t length = std::strlen(path);
+	json_ = length >= 5 && std::strcmp(path + length - 5, ".json") == 0;
+
+	if (json_)
+	{
+		std::fputs("[\n", file_);
+	}
+	else
+	{
+		std::fputs("time_s,phase,count,p50_ms,p99_ms,max_ms\n", file_);
+	}
+
+	SetEnabled(true);
+
+	return true;
+}
+
+void Metrics::Close()
+{
+	if (file_ == nullptr)
+	{
+		return;
+	}
+
+	if (json_)
+	{
+		std::fputs(generation_ > 0 ? "\n]\n" : "]\n", file_);
+	}
+
+	std::fclose(file_);
+	file_ = nullptr;
+}
+
+void Metrics::Update(bool force)
+{
+	if (!enabled_)
+	{
+		return;
+	}
+
+	const std::uint64_t now = SDL_GetPerformanceCounter();
+
+	if (force || now - interval_start_ >= frequency_ * constants::metrics_interval_ms / 1000)
+	{
+		Summarise(now);
+		interval_start_ = now;
+	}
+}
+
+void Metrics::Summarise(std::uint64_t now)
+{
+	const double ms_per_tick = 1000.0 / static_cast<double>(frequency_);
+	const double time = static_cast<double>(now - first_start_) / static_cast<double>(frequency_);
+
+	if (file_ != nullptr && json_)
+	{
+		std::fprintf(file_, "%s  {\"time_s\": %.3f, \"phases\": {", generation_ > 0 ? ",\n" : "", time);
+	}
+
+	for (int i = 0; i < phase_count; ++i)
+	{
+		LatencyHistogram& histogram = histograms_[i];
+		PhaseSummary& summary = summaries_[i];
+
+		summary.count = histogram.GetCount();
+		summary.p50_ms = histogram.GetPercentile(50.0) * ms_per_tick;
+		summary.p99_ms = histogram.GetPercentile(99.0) * ms_per_tick;
+		summary.max_ms = histogram.GetMax() * ms_per_tick;
+
+		histogram.Reset();
+
+		if (file_ == nullptr)
+		{
+			continue;
+		}
+
+		const char* name = GetPhaseName(static_cast<Phase>(i));
+
+		if (json_)
+		{
+			std::fprintf(file_, "%s\"%s\": {\"count\": %llu, \"p50_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f}", i > 0 ? ", " : "", 
+				name, static_cast<unsigned long long>(summary.count), summary.p50_ms, summary.p99_ms, summary.max_ms);
+		}
+		else
+		{
+			std::fprintf(file_, "%.3f,%s,%llu,%.4f,%.4f,%.4f\n", time, name, static_cast<unsigned long long>(summary.count), summary.p50_ms, summary.p99_ms, summary.max_ms);
+		}
+	}
+
+	if (file_ != nullptr)
+	{
+		if (json_)
+		{
+			std::fputs("}}", file_);
+		}
+
+		std::fflush(file_);
+	}
+
+	++generation_;
+}
+
+const PhaseSummary& Metrics::GetSummary(Phase phase) const
+{
+	return summaries_[static_cast<int>(phase)];
+}
+
+std::uint64_t Metrics::GetGeneration() const
+{
+	return generation_;
+}
+
+const char* Metrics::GetPhaseName(Phase phase)
+{
+	static constexpr const char* names[phase_count] = 
+	{
+		"events", 
+		"tick", 
+		"player", 
+		"ghosts", 
+		"collision", 
+		"render", 
+		"render_board", 
+		"render_entities", 
+		"render_info", 
+		"present"
+	};
+
+	return names[static_cast<int>(phase)];
+}
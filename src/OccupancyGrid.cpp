@@ -0,0 +1,117 @@
+#include "OccupancyGrid.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+OccupancyGrid::OccupancyGrid() : 
+	width_(0), 
+	height_(0)
+{
+}
+
+OccupancyGrid::~OccupancyGrid()
+{
+}
+
+void OccupancyGrid::Resize(int width, int height)
+{
+	width_ = width;
+	height_ = height;
+	counts_.assign(static_cast<std::size_t>(width) * height * static_cast<int>(Occupant::COUNT), 0);
+	crowded_.clear();
+	crossings_.assign(static_cast<std::size_t>(width) * height, 0);
+	crossed_tiles_.clear();
+}
+
+void OccupancyGrid::Clear()
+{
+	std::fill(counts_.begin(), counts_.end(), 0);
+	crowded_.clear();
+	BeginStep();
+}
+
+void OccupancyGrid::BeginStep()
+{
+	for (const int tile : crossed_tiles_)
+	{
+		crossings_[tile] = 0;
+	}
+
+	crossed_tiles_.clear();
+}
+
+void OccupancyGrid::Add(Occupant occupant, int tile)
+{
+	const std::size_t slot = static_cast<std::size_t>(tile) * static_cast<int>(Occupant::COUNT) + static_cast<int>(occupant);
+
+	if (counts_[slot] == crowded_count)
+	{
+		++crowded_[slot];
+	}
+	else if (++counts_[slot] == crowded_count)
+	{
+		crowded_[slot] = crowded_count;
+	}
+}
+
+void OccupancyGrid::Remove(Occupant occupant, int tile)
+{
+	const std::size_t slot = static_cast<std::size_t>(tile) * static_cast<int>(Occupant::COUNT) + static_cast<int>(occupant);
+
+	if (counts_[slot] != crowded_count)
+	{
+		--counts_[slot];
+		return;
+	}
+
+	const std::unordered_map<std::size_t, int>::iterator crowded = crowded_.find(slot);
+
+	if (--crowded->second < crowded_count)
+	{
+		counts_[slot] = static_cast<std::uint8_t>(crowded->second);
+		crowded_.erase(crowded);
+	}
+}
+
+void OccupancyGrid::Move(Occupant occupant, int from, int to, Direction direction)
+{
+	if (from == to)
+	{
+		return;
+	}
+
+	Remove(occupant, from);
+	Add(occupant, to);
+
+	if (direction == Direction::NONE)
+	{
+		return;
+	}
+
+	if (crossings_[to] == 0)
+	{
+		crossed_tiles_.push_back(to);
+	}
+
+	crossings_[to] |= static_cast<std::uint8_t>(1 << (static_cast<int>(occupant) * 4 + static_cast<int>(direction)));
+}
+
+int OccupancyGrid::CountWithin(Occupant occupant, int tile, int distance) const
+{
+	const int x = tile % width_;
+	const int y = tile / width_;
+	int count = 0;
+
+	// Rows of the diamond around the tile, clipped to the board.
+	for (int row = std::max(y - distance, 0); row <= std::min(y + distance, height_ - 1); ++row)
+	{
+		const int span = distance - std::abs(row - y);
+
+		for (int column = std::max(x - span, 0); column <= std::min(x + span, width_ - 1); ++column)
+		{
+			count += GetCount(occupant, row * width_ + column);
+		}
+	}
+
+	return count;
+}
@@ -1,7 +1,9 @@
 #include "Player.hpp"
 #include "Game.hpp"
 #include "Constants.hpp"
+#include "Trace.hpp"
 #include "Tile.hpp"
+#include "Zobrist.hpp"
 
 #include <SDL2/SDL.h>
 
@@ -19,38 +21,66 @@ void Player::HandleEvent(SDL_Event* e)
 {
 	if (e->type == SDL_KEYDOWN)
 	{
+		Direction direction = Direction::NONE;
+
 		if (e->key.keysym.sym == SDLK_UP)
 		{
-			SetDirection(Direction::UP);
+			direction = Direction::UP;
 		}
 		if (e->key.keysym.sym == SDLK_DOWN)
 		{
-			SetDirection(Direction::DOWN);
+			direction = Direction::DOWN;
 		}
 		if (e->key.keysym.sym == SDLK_LEFT)
 		{
-			SetDirection(Direction::LEFT);
+			direction = Direction::LEFT;
 		}
 		if (e->key.keysym.sym == SDLK_RIGHT)
 		{
-			SetDirection(Direction::RIGHT);
+			direction = Direction::RIGHT;
+		}
+
+		if (direction != Direction::NONE)
+		{
+			game_->RecordInput({ game_->game_ticks_, InputType::DIRECTION, direction });
+			SetDirection(direction);
 		}
 	}
 }
 
 void Player::Tick()
 {
+	TRACE_ZONE("Player::Tick");
+
+	Rewind* rewind = game_->GetRewind();
+	const int previous_tile = current_tile_;
+
 	if (!Move(queued_direction_))
 	{
 		Move(direction_);
 	}
 
-	if (current_tile_->pellet_spawned_)
+	if (rewind != nullptr && current_tile_ != previous_tile)
+	{
+		rewind->RecordPlayerTile(current_tile_);
+	}
+
+	if (level_->HasPellet(current_tile_))
 	{
+		if (rewind != nullptr)
+		{
+			rewind->RecordPellet(current_tile_);
+		}
+
 		EatPellet();
 	}
-	else if (current_tile_->energizer_spawned_)
+	else if (level_->HasEnergizer(current_tile_))
 	{
+		if (rewind != nullptr)
+		{
+			rewind->RecordPellet(current_tile_);
+		}
+
 		EatEnergizer();
 	}
 }
@@ -59,28 +89,29 @@ void Player::Render()
 {
 	//DebugNeighbors();
 
-	SDL_SetRenderDrawColor(game_->renderer_, 0xff, 0xff, 0x00, 0xff);
-	SDL_RenderFillRect(game_->renderer_, &current_tile_->rect_);
+	game_->GetDrawBuffer()->FillRect(DrawLayer::PLAYER, level_->GetTileRect(current_tile_), 0xff, 0xff, 0x00);
 }
 
 void Player::Spawn()
 {
-	current_tile_ = level_->GetTile(416, 736);
+	current_tile_ = level_->GetSpawn(SpawnPoint::PLAYER);
 	direction_ = Direction::LEFT;
 	queued_direction_ = Direction::NONE;
 }
 
 bool Player::Move(Direction direction)
 {
-	Tile* next_tile = GetNextTileInDirection(direction);
+	const int next_tile = GetNextTileInDirection(direction);
 
-	if (next_tile == nullptr || next_tile->type_ == TileType::GHOST_GATE)
+	if (next_tile == -1 || level_->GetTileType(next_tile) == TileType::GHOST_GATE)
 	{
 		return false;
 	}
 
-	if (next_tile != nullptr && !next_tile->IsWall())
+	if (!level_->IsWall(next_tile))
 	{
+		const std::uint64_t previous_key = GetHashKey();
+
 		current_tile_ = next_tile;
 
 		if (queued_direction_ == direction)
@@ -89,6 +120,8 @@ bool Player::Move(Direction direction)
 			queued_direction_ = Direction::NONE;
 		}
 
+		game_->ToggleHash(previous_key ^ GetHashKey());
+
 		return true;
 	}
 
@@ -97,52 +130,59 @@ bool Player::Move(Direction direction)
 
 void Player::EatPellet()
 {
-	current_tile_->pellet_spawned_ = false;
-	--level_->pellet_count_;
+	level_->EatPellet(current_tile_);
+	game_->TogglePelletHash(zobrist::Key(zobrist::Feature::PELLET, 0, current_tile_));
 	game_->score_ += 5;
-	game_->UpdateScoreTexture();
 }
 
 void Player::EatEnergizer()
 {
-	current_tile_->energizer_spawned_ = false;
-	--level_->energizer_count_;
+	level_->EatEnergizer(current_tile_);
+	game_->TogglePelletHash(zobrist::Key(zobrist::Feature::ENERGIZER, 0, current_tile_));
 	game_->score_ += 50;
-	game_->UpdateScoreTexture();
 }
 
-Tile* Player::GetNextTileInDirection(Direction direction)
+int Player::GetNextTileInDirection(Direction direction)
 {
-	if (direction == Direction::LEFT)
-	{	
-		return level_->GetLeftTile(current_tile_->rect_.x, current_tile_->rect_.y);
-	}
-	else if (direction == Direction::RIGHT)
-	{	
-		return level_->GetRightTile(current_tile_->rect_.x, current_tile_->rect_.y);
-	}
-	else if (direction == Direction::UP)
-	{
-		return level_->GetUpperTile(current_tile_->rect_.x, current_tile_->rect_.y);
-	}
-	else if (direction == Direction::DOWN)
+	if (direction == Direction::LEFT || direction == Direction::RIGHT || direction == Direction::UP || direction == Direction::DOWN)
 	{
-		return level_->GetLowerTile(current_tile_->rect_.x, current_tile_->rect_.y);
+		return level_->GetNeighbor(current_tile_, direction);
 	}
 
-	return nullptr;
+	return -1;
+}
+
+std::uint64_t Player::GetHashKey() const
+{
+	return zobrist::Key(zobrist::Feature::PLAYER_TILE, 0, current_tile_) ^ zobrist::Key(zobrist::Feature::PLAYER_DIRECTION, 0, static_cast<std::uint32_t>(direction_)) ^ zobrist::Key(zobrist::Feature::PLAYER_QUEUED_DIRECTION, 0, static_cast<std::uint32_t>(queued_direction_));
+}
+
+void Player::Snapshot(PlayerState& state) const
+{
+	state.tile = current_tile_;
+	state.direction = static_cast<std::uint8_t>(direction_);
+	state.queued_direction = static_cast<std::uint8_t>(queued_direction_);
+}
+
+void Player::Restore(const PlayerState& state)
+{
+	current_tile_ = state.tile;
+	direction_ = static_cast<Direction>(state.direction);
+	queued_direction_ = static_cast<Direction>(state.queued_direction);
 }
 
 void Player::SetDirection(Direction next_direction)
 {
-	Tile* next_tile = GetNextTileInDirection(next_direction);
+	const int next_tile = GetNextTileInDirection(next_direction);
 
-	if (next_tile == nullptr || next_tile->type_ == TileType::GHOST_GATE)
+	if (next_tile == -1 || level_->GetTileType(next_tile) == TileType::GHOST_GATE)
 	{
 		return;
 	}
 
-	if (!next_tile->IsWall())
+	const std::uint64_t previous_key = GetHashKey();
+
+	if (!level_->IsWall(next_tile))
 	{
 		direction_ = next_direction;
 	}
@@ -150,4 +190,6 @@ void Player::SetDirection(Direction next_direction)
 	{
 		queued_direction_ = next_direction;
 	}
+
+	game_->ToggleHash(previous_key ^ GetHashKey());
 }
@@ -0,0 +1,154 @@
+#include "Replay.hpp"
+#include "ByteOrder.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	constexpr char replay_magic[4] = { 'P', 'M', 'R', 'P' };
+	constexpr std::uint16_t replay_version = 2;
+	constexpr std::size_t header_size = 32;
+	constexpr int reset_code = 4;
+}
+
+ReplayRecorder::ReplayRecorder() : last_tick_(0)
+{
+}
+
+ReplayRecorder::~ReplayRecorder()
+{
+}
+
+void ReplayRecorder::Record(const InputEvent& event)
+{
+	const int code = event.type == InputType::RESET ? reset_code : static_cast<int>(event.direction);
+	std::uint64_t value = (static_cast<std::uint64_t>(event.tick - last_tick_) << 3) | static_cast<std::uint64_t>(code);
+
+	last_tick_ = event.tick;
+
+	while (value >= 0x80)
+	{
+		events_.push_back(static_cast<std::uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+
+	events_.push_back(static_cast<std::uint8_t>(value));
+}
+
+bool ReplayRecorder::Save(const char* path, const ReplayHeader& header) const
+{
+	std::uint8_t bytes[header_size];
+
+	std::memcpy(bytes, replay_magic, sizeof(replay_magic));
+	WriteLittleEndian(bytes + 4, replay_version, 2);
+	WriteLittleEndian(bytes + 6, header.tick_rate, 2);
+	WriteLittleEndian(bytes + 8, header.logic_step_ticks, 2);
+	WriteLittleEndian(bytes + 10, header.starting_lives, 2);
+	WriteLittleEndian(bytes + 12, header.length_ticks, 4);
+	WriteLittleEndian(bytes + 16, header.level_hash, 8);
+	WriteLittleEndian(bytes + 24, header.ghost_count, 4);
+	WriteLittleEndian(bytes + 28, 0, 4);
+
+	FILE* file = std::fopen(path, "wb");
+
+	if (file == nullptr)
+	{
+		printf("Unable to write replay %s!\n", path);
+		return false;
+	}
+
+	const bool written = std::fwrite(bytes, 1, header_size, file) == header_size && std::fwrite(events_.data(), 1, events_.size(), file) == events_.size();
+
+	std::fclose(file);
+	return written;
+}
+
+ReplayReader::ReplayReader() : header_{ 0, 0, 0, 0, 0, 0 }, cursor_(nullptr), end_(nullptr), next_{ 0, InputType::DIRECTION, Direction::NONE }, has_next_(false)
+{
+}
+
+ReplayReader::~ReplayReader()
+{
+}
+
+bool ReplayReader::Open(const char* path)
+{
+	has_next_ = false;
+
+	if (!file_.Open(path))
+	{
+		return false;
+	}
+
+	const std::uint8_t* data = file_.GetData();
+
+	if (file_.GetSize() < header_size || std::memcmp(data, replay_magic, sizeof(replay_magic)) != 0 || ReadLittleEndian(data + 4, 2) != replay_version)
+	{
+		printf("%s is not a replay file!\n", path);
+		file_.Close();
+		return false;
+	}
+
+	header_.tick_rate = static_cast<std::uint16_t>(ReadLittleEndian(data + 6, 2));
+	header_.logic_step_ticks = static_cast<std::uint16_t>(ReadLittleEndian(data + 8, 2));
+	header_.starting_lives = static_cast<std::uint16_t>(ReadLittleEndian(data + 10, 2));
+	header_.length_ticks = static_cast<std::uint32_t>(ReadLittleEndian(data + 12, 4));
+	header_.level_hash = ReadLittleEndian(data + 16, 8);
+	header_.ghost_count = static_cast<std::uint32_t>(ReadLittleEndian(data + 24, 4));
+
+	cursor_ = data + header_size;
+	end_ = data + file_.GetSize();
+	next_.tick = 0;
+
+	Decode();
+	return true;
+}
+
+const ReplayHeader& ReplayReader::GetHeader() const
+{
+	return header_;
+}
+
+const InputEvent* ReplayReader::Peek() const
+{
+	return has_next_ ? &next_ : nullptr;
+}
+
+void ReplayReader::Advance()
+{
+	Decode();
+}
+
+void ReplayReader::Decode()
+{
+	std::uint64_t value = 0;
+	int shift = 0;
+
+	has_next_ = false;
+
+	while (cursor_ < end_ && shift < 64)
+	{
+		const std::uint8_t byte = *cursor_++;
+		value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+		shift += 7;
+
+		if ((byte & 0x80) == 0)
+		{
+			const int code = static_cast<int>(value & 0x7);
+
+			if (code > reset_code)
+			{
+				printf("Corrupt replay event, stopping playback.\n");
+				cursor_ = end_;
+				return;
+			}
+
+			next_.tick += static_cast<int>(value >> 3);
+			next_.type = code == reset_code ? InputType::RESET : InputType::DIRECTION;
+			next_.direction = code == reset_code ? Direction::NONE : static_cast<Direction>(code);
+			has_next_ = true;
+			return;
+		}
+	}
+}
@@ -0,0 +1,207 @@
+#include "Rewind.hpp"
+#include "Constants.hpp"
+
+#include <cstring>
+
+namespace
+{
+	// Each delta is a varint holding (payload << 3) | tag. Inputs pack (ticks since the keyframe << 3)
+	// | code like replays do, and a ghost's tile is followed by a second varint with its index.
+	enum DeltaTag
+	{
+		END_STEP, INPUT, PLAYER_TILE, GHOST_TILE, PELLET, RESET
+	};
+
+	constexpr int reset_code = 4;
+
+	void PutVarint(std::vector<std::uint8_t>& bytes, std::uint64_t value)
+	{
+		while (value >= 0x80)
+		{
+			bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+
+		bytes.push_back(static_cast<std::uint8_t>(value));
+	}
+
+	std::uint64_t GetVarint(const std::vector<std::uint8_t>& bytes, std::size_t& offset)
+	{
+		std::uint64_t value = 0;
+
+		for (int shift = 0; offset < bytes.size(); shift += 7)
+		{
+			const std::uint8_t byte = bytes[offset++];
+			value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+
+			if ((byte & 0x80) == 0)
+			{
+				break;
+			}
+		}
+
+		return value;
+	}
+}
+
+Rewind::Rewind(int seconds, int keyframe_steps) : 
+	segments_(static_cast<std::size_t>(seconds * constants::tick_rate / constants::logic_step_ticks / keyframe_steps + 2)), 
+	first_(0), 
+	count_(0), 
+	keyframe_steps_(keyframe_steps), 
+	desynced_(false)
+{
+}
+
+Rewind::~Rewind()
+{
+}
+
+Rewind::Segment& Rewind::GetCurrent()
+{
+	return segments_[(first_ + count_ - 1) % segments_.size()];
+}
+
+void Rewind::Write(std::uint64_t value, int tag)
+{
+	PutVarint(GetCurrent().deltas, (value << 3) | static_cast<std::uint64_t>(tag));
+}
+
+void Rewind::BeginSegment(const GameState& keyframe)
+{
+	if (count_ == static_cast<int>(segments_.size()))
+	{
+		first_ = (first_ + 1) % static_cast<int>(segments_.size());
+		--count_;
+	}
+
+	++count_;
+
+	Segment& segment = GetCurrent();
+
+	segment.keyframe = keyframe;
+	segment.deltas.clear();
+	segment.steps = 0;
+}
+
+void Rewind::RecordInput(const InputEvent& event)
+{
+	const int code = event.type == InputType::RESET ? reset_code : static_cast<int>(event.direction);
+
+	Write((static_cast<std::uint64_t>(event.tick - GetCurrent().keyframe.game_ticks) << 3) | static_cast<std::uint64_t>(code), INPUT);
+}
+
+void Rewind::RecordPlayerTile(int tile)
+{
+	Write(static_cast<std::uint64_t>(tile), PLAYER_TILE);
+}
+
+void Rewind::RecordGhostTile(int index, int tile)
+{
+	Write(static_cast<std::uint64_t>(tile), GHOST_TILE);
+	PutVarint(GetCurrent().deltas, static_cast<std::uint64_t>(index));
+}
+
+void Rewind::RecordPellet(int tile)
+{
+	Write(static_cast<std::uint64_t>(tile), PELLET);
+}
+
+void Rewind::RecordReset()
+{
+	Write(0, RESET);
+}
+
+bool Rewind::EndStep()
+{
+	Segment& segment = GetCurrent();
+
+	Write(0, END_STEP);
+	++segment.steps;
+
+	if (!expected_.empty() && (segment.deltas.size() > expected_.size() || std::memcmp(segment.deltas.data(), expected_.data(), segment.deltas.size()) != 0))
+	{
+		desynced_ = true;
+	}
+
+	if (segment.steps < keyframe_steps_)
+	{
+		return false;
+	}
+
+	expected_.clear();
+
+	return true;
+}
+
+bool Rewind::Truncate(int tick, GameState& keyframe, InputScript& inputs)
+{
+	int kept = count_;
+
+	while (kept > 0 && segments_[(first_ + kept - 1) % segments_.size()].keyframe.game_ticks > tick)
+	{
+		--kept;
+	}
+
+	if (kept == 0)
+	{
+		return false;
+	}
+
+	Segment& segment = segments_[(first_ + kept - 1) % segments_.size()];
+
+	keyframe = segment.keyframe;
+	inputs.clear();
+
+	for (std::size_t offset = 0; offset < segment.deltas.size();)
+	{
+		const std::uint64_t value = GetVarint(segment.deltas, offset);
+
+		if ((value & 0x7) == GHOST_TILE)
+		{
+			GetVarint(segment.deltas, offset);
+		}
+		else if ((value & 0x7) == INPUT)
+		{
+			const int code = static_cast<int>((value >> 3) & 0x7);
+			const int input_tick = keyframe.game_ticks + static_cast<int>(value >> 6);
+
+			inputs.push_back({ input_tick, code == reset_code ? InputType::RESET : InputType::DIRECTION, code == reset_code ? Direction::NONE : static_cast<Direction>(code) });
+		}
+	}
+
+	// The segment's slot is reused for the re-simulated run; its old deltas become what that run
+	// should write again.
+	expected_.swap(segment.deltas);
+	desynced_ = false;
+	count_ = kept - 1;
+
+	return true;
+}
+
+bool Rewind::FinishSeek()
+{
+	const bool matched = !desynced_;
+
+	expected_.clear();
+	desynced_ = false;
+
+	return matched;
+}
+
+int Rewind::GetOldestTick() const
+{
+	return count_ > 0 ? segments_[first_].keyframe.game_ticks : 0;
+}
+
+std::size_t Rewind::GetMemoryUsage() const
+{
+	std::size_t bytes = sizeof(Rewind) + segments_.size() * sizeof(Segment) + expected_.capacity();
+
+	for (const Segment& segment : segments_)
+	{
+		bytes += segment.deltas.capacity();
+	}
+
+	return bytes;
+}
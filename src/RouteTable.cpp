@@ -0,0 +1,218 @@
+#include "RouteTable.hpp"
+#include "Level.hpp"
+#include "Constants.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+	// Built tables by level hash. Entries go away with the last game using them, except the most
+	// recent table, which stays so games created one after another (a one-thread batch) reuse it.
+	std::mutex tables_mutex;
+	std::unordered_map<std::uint64_t, std::weak_ptr<const RouteTable>> tables;
+	std::shared_ptr<const RouteTable> latest_table;
+}
+
+RouteTable::RouteTable() : count_(0)
+{
+}
+
+RouteTable::~RouteTable()
+{
+}
+
+std::shared_ptr<const RouteTable> RouteTable::Get(Level* level)
+{
+	// Held while building, so games loading the same level at once wait for one build.
+	std::lock_guard<std::mutex> lock(tables_mutex);
+
+	std::shared_ptr<const RouteTable> table = tables[level->GetHash()].lock();
+
+	if (table == nullptr)
+	{
+		std::shared_ptr<RouteTable> built = std::make_shared<RouteTable>();
+
+		if (!built->Build(level))
+		{
+			tables.erase(level->GetHash());
+			return nullptr;
+		}
+
+		for (auto entry = tables.begin(); entry != tables.end();)
+		{
+			entry = entry->second.expired() ? tables.erase(entry) : std::next(entry);
+		}
+
+		table = built;
+		tables[level->GetHash()] = table;
+	}
+
+	latest_table = table;
+
+	return table;
+}
+
+bool RouteTable::Build(Level* level)
+{
+	TRACE_ZONE("RouteTable::Build");
+
+	const int tile_count = level->GetTileCount();
+
+	std::vector<int>().swap(index_);
+	std::vector<int>().swap(proxy_);
+	std::vector<std::uint8_t>().swap(routes_);
+	count_ = 0;
+
+	int walkable_count = 0;
+
+	for (int i = 0; i < tile_count; ++i)
+	{
+		walkable_count += level->IsWall(i) ? 0 : 1;
+	}
+
+	// A byte per pair of walkable tiles plus two ints per tile. Building takes time quadratic in
+	// walkable tiles as well, so mazes over the budget fall back to flow field steering and are
+	// turned away before anything is allocated.
+	const std::size_t table_bytes = static_cast<std::size_t>(walkable_count) * walkable_count + static_cast<std::size_t>(tile_count) * 2 * sizeof(int);
+
+	if (walkable_count == 0 || table_bytes > static_cast<std::size_t>(constants::max_route_table_bytes))
+	{
+		return false;
+	}
+
+	index_.assign(tile_count, -1);
+	proxy_.assign(tile_count, -1);
+
+	std::vector<int> walkable;
+	walkable.reserve(walkable_count);
+
+	for (int i = 0; i < tile_count; ++i)
+	{
+		if (!level->IsWall(i))
+		{
+			index_[i] = count_++;
+			walkable.push_back(i);
+		}
+	}
+
+	std::vector<int> queue;
+	queue.reserve(tile_count);
+
+	// Targets inside walls, such as the scatter corners, are routed to the closest walkable tile.
+	for (const int tile : walkable)
+	{
+		proxy_[tile] = index_[tile];
+		queue.push_back(tile);
+	}
+
+	for (std::size_t head = 0; head < queue.size(); ++head)
+	{
+		const int tile = queue[head];
+
+		for (int i = 0; i < 4; ++i)
+		{
+			const int neighbor = level->GetNeighbor(tile, static_cast<Direction>(i));
+
+			if (neighbor != -1 && proxy_[neighbor] == -1)
+			{
+				proxy_[neighbor] = proxy_[tile];
+				queue.push_back(neighbor);
+			}
+		}
+	}
+
+	// The ghost moves, worked out once: where each direction out of a tile leads (-1 where a ghost
+	// may not step) and, the other way round, which tile steps onto a tile in each direction.
+	std::vector<std::array<int, 4>> steps(count_);
+	std::vector<std::array<int, 4>> sources(count_);
+
+	for (std::array<int, 4>& entry : sources)
+	{
+		entry.fill(-1);
+	}
+
+	for (const int source : walkable)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			const Direction direction = static_cast<Direction>(i);
+			const int step = level->CanGhostStep(source, direction) ? index_[level->GetNeighbor(source, direction)] : -1;
+
+			steps[index_[source]][i] = step;
+
+			if (step != -1)
+			{
+				sources[step][i] = index_[source];
+			}
+		}
+	}
+
+	constexpr int unreachable = std::numeric_limits<int>::max() / 2;
+	std::vector<int> distance(count_);
+	std::vector<int> route_queue;
+	route_queue.reserve(count_);
+
+	routes_.resize(static_cast<std::size_t>(count_) * count_);
+
+	for (int target = 0; target < count_; ++target)
+	{
+		// Walk the ghost moves backwards from the target to get every tile's distance to it.
+		std::fill(distance.begin(), distance.end(), unreachable);
+		distance[target] = 0;
+
+		route_queue.clear();
+		route_queue.push_back(target);
+
+		for (std::size_t head = 0; head < route_queue.size(); ++head)
+		{
+			const int tile = route_queue[head];
+
+			for (const int source : sources[tile])
+			{
+				if (source != -1 && distance[source] == unreachable)
+				{
+					distance[source] = distance[tile] + 1;
+					route_queue.push_back(source);
+				}
+			}
+		}
+
+		std::uint8_t* row = &routes_[static_cast<std::size_t>(target) * count_];
+
+		for (int source = 0; source < count_; ++source)
+		{
+			int cost[4];
+
+			for (int i = 0; i < 4; ++i)
+			{
+				cost[i] = steps[source][i] != -1 ? distance[steps[source][i]] : 2 * unreachable;
+			}
+
+			// A direction's rank is how many directions beat it: cheaper ones, and equally cheap
+			// ones earlier in Direction order. That is a stable sort of four without sorting.
+			int packed = 0;
+
+			for (int i = 0; i < 4; ++i)
+			{
+				int rank = 0;
+
+				for (int j = 0; j < 4; ++j)
+				{
+					rank += j < i ? cost[j] <= cost[i] : cost[j] < cost[i];
+				}
+
+				packed |= i << (rank * 2);
+			}
+
+			row[source] = static_cast<std::uint8_t>(packed);
+		}
+	}
+
+	return true;
+}
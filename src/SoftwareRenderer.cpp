@@ -0,0 +1,315 @@
+#include "SoftwareRenderer.hpp"
+#include "Constants.hpp"
+#include "Trace.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// The colour's bytes in R, G, B, A order, as one word.
+	std::uint32_t PackPixel(Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+	{
+		const Uint8 bytes[4] = { r, g, b, a };
+		std::uint32_t pixel = 0;
+		std::memcpy(&pixel, bytes, sizeof(pixel));
+
+		return pixel;
+	}
+
+	void FillSpan(std::uint8_t* pixels, int count, std::uint32_t pixel)
+	{
+		int i = 0;
+
+#if defined(__SSE2__)
+		const __m128i packed = _mm_set1_epi32(static_cast<int>(pixel));
+
+		for (; i + 8 <= count; i += 8)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i * 4), packed);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i * 4 + 16), packed);
+		}
+
+		for (; i + 4 <= count; i += 4)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i * 4), packed);
+		}
+#endif
+
+		for (; i < count; ++i)
+		{
+			std::memcpy(pixels + i * 4, &pixel, sizeof(pixel));
+		}
+	}
+
+	Uint8 Blend(int source, int destination, int alpha)
+	{
+		return static_cast<Uint8>((source * alpha + destination * (255 - alpha) + 127) / 255);
+	}
+}
+
+SoftwareRenderer::SoftwareRenderer(float scale, FrameFormat format, ThreadPool* pool) : 
+	palette_{ { 0x00, 0x00, 0x00, 0xff } }, 
+	pool_(pool), 
+	scale_(scale), 
+	format_(format), 
+	width_(0), 
+	height_(0)
+{
+	width_ = ScaleEdge(constants::screen_width);
+	height_ = ScaleEdge(constants::screen_height);
+}
+
+SoftwareRenderer::~SoftwareRenderer()
+{
+}
+
+int SoftwareRenderer::ScaleEdge(int edge) const
+{
+	// A pixel belongs to the rectangle its centre falls in.
+	return static_cast<int>(std::ceil(edge * scale_ - 0.5f));
+}
+
+bool SoftwareRenderer::Place(const SDL_Rect& destination, const SDL_Rect& viewport, Operation& operation) const
+{
+	const int left = std::max(viewport.x + destination.x, viewport.x);
+	const int top = std::max(viewport.y + destination.y, viewport.y);
+	const int right = std::min(viewport.x + destination.x + destination.w, viewport.x + viewport.w);
+	const int bottom = std::min(viewport.y + destination.y + destination.h, viewport.y + viewport.h);
+
+	operation.x0 = std::clamp(ScaleEdge(left), 0, width_);
+	operation.y0 = std::clamp(ScaleEdge(top), 0, height_);
+	operation.x1 = std::clamp(ScaleEdge(right), 0, width_);
+	operation.y1 = std::clamp(ScaleEdge(bottom), 0, height_);
+
+	return operation.x0 < operation.x1 && operation.y0 < operation.y1;
+}
+
+void SoftwareRenderer::SetColor(const SDL_Color& color, Operation& operation)
+{
+	operation.color = PackPixel(color.r, color.g, color.b, color.a);
+
+	if (format_ != FrameFormat::INDEXED)
+	{
+		return;
+	}
+
+	int best = 0;
+	int best_distance = -1;
+
+	for (int i = 0; i < static_cast<int>(palette_.size()); ++i)
+	{
+		const int dr = palette_[i].r - color.r;
+		const int dg = palette_[i].g - color.g;
+		const int db = palette_[i].b - color.b;
+		const int distance = dr * dr + dg * dg + db * db;
+
+		if (best_distance == -1 || distance < best_distance)
+		{
+			best = i;
+			best_distance = distance;
+		}
+	}
+
+	// Once all 256 indices are taken new colours share the closest one.
+	if (best_distance != 0 && palette_.size() < 256)
+	{
+		best = static_cast<int>(palette_.size());
+		palette_.push_back({ color.r, color.g, color.b, 0xff });
+	}
+
+	operation.index = static_cast<std::uint8_t>(best);
+}
+
+void SoftwareRenderer::DrawRects(DrawBuffer* draw_buffer, const SDL_Rect& viewport)
+{
+	draw_buffer->TakeCommands(commands_);
+
+	// The same order DrawBuffer::Flush draws in, so both paths overlap commands alike.
+	std::stable_sort(commands_.begin(), commands_.end(), DrawBuffer::DrawsBefore);
+
+	for (const DrawCommand& command : commands_)
+	{
+		Operation operation = {};
+
+		if (command.texture != nullptr || !Place(command.destination, viewport, operation))
+		{
+			continue;
+		}
+
+		SetColor({ static_cast<Uint8>(command.color >> 24), static_cast<Uint8>((command.color >> 16) & 0xff), static_cast<Uint8>((command.color >> 8) & 0xff), static_cast<Uint8>(command.color & 0xff) }, operation);
+		operations_.push_back(operation);
+	}
+}
+
+void SoftwareRenderer::DrawText(const GlyphAtlas& atlas, const TextLayout& layout, const SDL_Rect& viewport, int x, int y, const SDL_Color& color)
+{
+	if (atlas.GetCoverage().empty())
+	{
+		return;
+	}
+
+	for (const GlyphQuad& quad : layout.quads)
+	{
+		const SDL_Rect destination = { x + quad.destination.x, y + quad.destination.y, quad.destination.w, quad.destination.h };
+		Operation operation = {};
+
+		if (!Place(destination, viewport, operation))
+		{
+			continue;
+		}
+
+		SetColor(color, operation);
+
+		operation.atlas = &atlas;
+		operation.source = quad.source;
+		operation.du = static_cast<float>(quad.source.w) / (quad.destination.w * scale_);
+		operation.dv = static_cast<float>(quad.source.h) / (quad.destination.h * scale_);
+		operation.u0 = quad.source.x + (0.5f / scale_ - (viewport.x + destination.x)) * quad.source.w / quad.destination.w;
+		operation.v0 = quad.source.y + (0.5f / scale_ - (viewport.y + destination.y)) * quad.source.h / quad.destination.h;
+
+		operations_.push_back(operation);
+	}
+}
+
+void SoftwareRenderer::Flush(std::uint8_t* pixels)
+{
+	TRACE_ZONE("SoftwareRenderer::Flush");
+
+	const int bands = pool_ != nullptr ? std::min(pool_->GetThreadCount(), height_) : 1;
+
+	if (bands <= 1)
+	{
+		DrawRows(pixels, 0, height_);
+	}
+	else
+	{
+		const int band_rows = (height_ + bands - 1) / bands;
+
+		for (int first_row = 0; first_row < height_; first_row += band_rows)
+		{
+			const int last_row = std::min(first_row + band_rows, height_);
+
+			pool_->Submit([this, pixels, first_row, last_row]()
+			{
+				DrawRows(pixels, first_row, last_row);
+			});
+		}
+
+		pool_->Wait();
+	}
+
+	operations_.clear();
+}
+
+void SoftwareRenderer::DrawRows(std::uint8_t* pixels, int first_row, int last_row) const
+{
+	const std::size_t pixel_size = format_ == FrameFormat::RGBA ? 4 : 1;
+	const std::size_t pitch = width_ * pixel_size;
+
+	if (format_ == FrameFormat::RGBA)
+	{
+		FillSpan(pixels + first_row * pitch, (last_row - first_row) * width_, PackPixel(0x00, 0x00, 0x00, 0xff));
+	}
+	else
+	{
+		std::memset(pixels + first_row * pitch, 0, (last_row - first_row) * pitch);
+	}
+
+	for (const Operation& operation : operations_)
+	{
+		const int y0 = std::max(operation.y0, first_row);
+		const int y1 = std::min(operation.y1, last_row);
+
+		if (operation.atlas == nullptr)
+		{
+			for (int y = y0; y < y1; ++y)
+			{
+				std::uint8_t* row = pixels + y * pitch + operation.x0 * pixel_size;
+
+				if (format_ == FrameFormat::RGBA)
+				{
+					FillSpan(row, operation.x1 - operation.x0, operation.color);
+				}
+				else
+				{
+					std::memset(row, operation.index, operation.x1 - operation.x0);
+				}
+			}
+
+			continue;
+		}
+
+		const std::vector<std::uint8_t>& coverage = operation.atlas->GetCoverage();
+		const int coverage_width = operation.atlas->GetCoverageWidth();
+		Uint8 color[4];
+		std::memcpy(color, &operation.color, sizeof(color));
+
+		for (int y = y0; y < y1; ++y)
+		{
+			const int v = std::clamp(static_cast<int>(operation.v0 + y * operation.dv), operation.source.y, operation.source.y + operation.source.h - 1);
+			const std::uint8_t* texels = coverage.data() + v * coverage_width;
+			std::uint8_t* row = pixels + y * pitch;
+
+			for (int x = operation.x0; x < operation.x1; ++x)
+			{
+				const int u = std::clamp(static_cast<int>(operation.u0 + x * operation.du), operation.source.x, operation.source.x + operation.source.w - 1);
+				const int alpha = texels[u] * color[3] / 255;
+
+				if (alpha == 0)
+				{
+					continue;
+				}
+
+				if (format_ == FrameFormat::INDEXED)
+				{
+					if (alpha >= 128)
+					{
+						row[x] = operation.index;
+					}
+
+					continue;
+				}
+
+				Uint8* pixel = row + x * 4;
+
+				pixel[0] = Blend(color[0], pixel[0], alpha);
+				pixel[1] = Blend(color[1], pixel[1], alpha);
+				pixel[2] = Blend(color[2], pixel[2], alpha);
+				pixel[3] = static_cast<Uint8>(alpha + pixel[3] * (255 - alpha) / 255);
+			}
+		}
+	}
+}
+
+int SoftwareRenderer::GetWidth() const
+{
+	return width_;
+}
+
+int SoftwareRenderer::GetHeight() const
+{
+	return height_;
+}
+
+std::size_t SoftwareRenderer::GetFrameSize() const
+{
+	return static_cast<std::size_t>(width_) * height_ * (format_ == FrameFormat::RGBA ? 4 : 1);
+}
+
+FrameFormat SoftwareRenderer::GetFormat() const
+{
+	return format_;
+}
+
+const std::vector<SDL_Color>& SoftwareRenderer::GetPalette() const
+{
+	return palette_;
+}
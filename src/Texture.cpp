@@ -1,4 +1,5 @@
 #include "Texture.hpp"
+#include "Trace.hpp"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
@@ -18,6 +19,7 @@ void Texture::FreeTexture()
 	if (texture_ != nullptr)
 	{
 		SDL_DestroyTexture(texture_);
+		texture_ = nullptr;
 		width_ = 0;
 		height_ = 0;
 	}
@@ -58,6 +60,8 @@ bool Texture::LoadFromPath(SDL_Renderer* renderer, const char* path)
 
 bool Texture::LoadFromText(SDL_Renderer* renderer, TTF_Font* font, const char* text, const SDL_Color& text_color, int text_length)
 {
+	TRACE_ZONE("Texture::LoadFromText");
+
 	FreeTexture();
 
 	SDL_Surface* text_surface = text_length == -1 ? TTF_RenderText_Blended(font, text, text_color) : TTF_RenderText_Blended_Wrapped(font, text, text_color, text_length);
@@ -83,6 +87,40 @@ bool Texture::LoadFromText(SDL_Renderer* renderer, TTF_Font* font, const char* t
 	return true;
 }
 
+bool Texture::LoadFromSurface(SDL_Renderer* renderer, SDL_Surface* surface)
+{
+	FreeTexture();
+
+	texture_ = SDL_CreateTextureFromSurface(renderer, surface);
+
+	if (texture_ == nullptr)
+	{
+		printf("Unable to create texture from surface! SDL Error: %s\n", SDL_GetError());
+		return false;
+	}
+
+	width_ = surface->w;
+	height_ = surface->h;
+	return true;
+}
+
+bool Texture::CreateTarget(SDL_Renderer* renderer, int width, int height)
+{
+	FreeTexture();
+
+	texture_ = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+
+	if (texture_ == nullptr)
+	{
+		printf("Unable to create target texture! SDL Error: %s\n", SDL_GetError());
+		return false;
+	}
+
+	width_ = width;
+	height_ = height;
+	return true;
+}
+
 void Texture::Render(SDL_Renderer* renderer, int x, int y, float scale, SDL_Rect* clip)
 {
 	SDL_Rect render_rect = { x, y, static_cast<int>(width_ * scale), static_cast<int>(height_ * scale) };
@@ -0,0 +1,177 @@
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
+
+#include <chrono>
+#include <string>
+
+ThreadPool::ThreadPool(int thread_count) : 
+	queued_(0), 
+	pending_(0), 
+	stopping_(false), 
+	next_worker_(0)
+{
+	if (thread_count < 1)
+	{
+		thread_count = 1;
+	}
+
+	for (int i = 0; i < thread_count; ++i)
+	{
+		workers_.emplace_back(std::make_unique<Worker>());
+		workers_.back()->busy_ns_ = 0;
+		workers_.back()->executed_ = 0;
+		workers_.back()->stolen_ = 0;
+	}
+
+	for (int i = 0; i < thread_count; ++i)
+	{
+		threads_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(wait_mutex_);
+		stopping_ = true;
+	}
+
+	work_available_.notify_all();
+
+	for (std::thread& thread : threads_)
+	{
+		thread.join();
+	}
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+	++pending_;
+
+	Worker& worker = *workers_[next_worker_++ % workers_.size()];
+
+	{
+		std::lock_guard<std::mutex> lock(worker.mutex_);
+		worker.tasks_.push_back(std::move(task));
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(wait_mutex_);
+		++queued_;
+	}
+
+	work_available_.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+	std::unique_lock<std::mutex> lock(wait_mutex_);
+	work_done_.wait(lock, [this]()
+	{
+		return pending_ == 0;
+	});
+}
+
+int ThreadPool::GetThreadCount() const
+{
+	return static_cast<int>(threads_.size());
+}
+
+WorkerStats ThreadPool::GetWorkerStats(int index) const
+{
+	const Worker& worker = *workers_[index];
+	return { static_cast<double>(worker.busy_ns_) / 1e9, worker.executed_, worker.stolen_ };
+}
+
+void ThreadPool::ResetStats()
+{
+	for (const std::unique_ptr<Worker>& worker : workers_)
+	{
+		worker->busy_ns_ = 0;
+		worker->executed_ = 0;
+		worker->stolen_ = 0;
+	}
+}
+
+void ThreadPool::WorkerLoop(int index)
+{
+	Worker& self = *workers_[index];
+
+	const std::string thread_name = "worker " + std::to_string(index);
+	Trace::SetThreadName(thread_name.c_str());
+
+	while (true)
+	{
+		std::function<void()> task;
+
+		if (PopLocal(index, task) || Steal(index, task))
+		{
+			--queued_;
+
+			const auto start = std::chrono::steady_clock::now();
+			task();
+			const auto end = std::chrono::steady_clock::now();
+
+			self.busy_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+			++self.executed_;
+
+			if (--pending_ == 0)
+			{
+				std::lock_guard<std::mutex> lock(wait_mutex_);
+				work_done_.notify_all();
+			}
+
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(wait_mutex_);
+		work_available_.wait(lock, [this]()
+		{
+			return stopping_ || queued_ > 0;
+		});
+
+		if (stopping_ && queued_ <= 0)
+		{
+			return;
+		}
+	}
+}
+
+bool ThreadPool::PopLocal(int index, std::function<void()>& task)
+{
+	Worker& self = *workers_[index];
+	std::lock_guard<std::mutex> lock(self.mutex_);
+
+	if (self.tasks_.empty())
+	{
+		return false;
+	}
+
+	// Own work is taken LIFO for cache warmth, thieves take the oldest task from the front.
+	task = std::move(self.tasks_.back());
+	self.tasks_.pop_back();
+	return true;
+}
+
+bool ThreadPool::Steal(int index, std::function<void()>& task)
+{
+	const int count = static_cast<int>(workers_.size());
+
+	for (int offset = 1; offset < count; ++offset)
+	{
+		Worker& victim = *workers_[(index + offset) % count];
+		std::lock_guard<std::mutex> lock(victim.mutex_);
+
+		if (victim.tasks_.empty())
+		{
+			continue;
+		}
+
+		task = std::move(victim.tasks_.front());
+		victim.tasks_.pop_front();
+		++workers_[index]->stolen_;
+		return true;
+	}
+
+	return false;
+}
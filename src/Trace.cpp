@@ -0,0 +1,164 @@
+#include "Trace.hpp"
+#include "Constants.hpp"
+
+#include <cstdio>
+
+std::atomic<bool> Trace::enabled_(false);
+std::mutex Trace::buffers_mutex_;
+std::vector<std::unique_ptr<TraceBuffer>> Trace::buffers_;
+std::string Trace::path_;
+std::uint64_t Trace::start_ = 0;
+
+TraceBuffer::TraceBuffer(int thread_id, std::size_t capacity) : 
+	events_(capacity), 
+	mask_(capacity - 1), 
+	written_(0), 
+	thread_name_("thread " + std::to_string(thread_id)), 
+	thread_id_(thread_id)
+{
+}
+
+void TraceBuffer::SetThreadName(const char* name)
+{
+	thread_name_ = name;
+}
+
+const std::string& TraceBuffer::GetThreadName() const
+{
+	return thread_name_;
+}
+
+int TraceBuffer::GetThreadId() const
+{
+	return thread_id_;
+}
+
+std::uint64_t TraceBuffer::GetWritten() const
+{
+	return written_.load(std::memory_order_acquire);
+}
+
+std::uint64_t TraceBuffer::GetCapacity() const
+{
+	return mask_ + 1;
+}
+
+const TraceEvent& TraceBuffer::GetEvent(std::uint64_t index) const
+{
+	return events_[index & mask_];
+}
+
+TraceBuffer* Trace::GetThreadBuffer()
+{
+	thread_local TraceBuffer* buffer = nullptr;
+
+	// Registration is the only locked step, once per thread; recording itself never locks.
+	if (buffer == nullptr)
+	{
+		std::lock_guard<std::mutex> lock(buffers_mutex_);
+		buffers_.emplace_back(std::make_unique<TraceBuffer>(static_cast<int>(buffers_.size()), constants::trace_buffer_events));
+		buffer = buffers_.back().get();
+	}
+
+	return buffer;
+}
+
+void Trace::Start(const char* path)
+{
+	path_ = path;
+	start_ = SDL_GetPerformanceCounter();
+	enabled_.store(true, std::memory_order_relaxed);
+}
+
+bool Trace::Stop()
+{
+	if (!enabled_.exchange(false))
+	{
+		return false;
+	}
+
+	FILE* file = std::fopen(path_.c_str(), "w");
+
+	if (file == nullptr)
+	{
+		printf("Unable to write trace %s!\n", path_.c_str());
+		return false;
+	}
+
+	const double us_per_tick = 1000000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+	std::uint64_t total = 0;
+	std::uint64_t dropped = 0;
+
+	std::fputs("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n", file);
+	std::fputs("{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"pacman\"}}", file);
+
+	std::lock_guard<std::mutex> lock(buffers_mutex_);
+
+	for (const std::unique_ptr<TraceBuffer>& buffer : buffers_)
+	{
+		const int tid = buffer->GetThreadId();
+		const std::uint64_t written = buffer->GetWritten();
+		const std::uint64_t first = written > buffer->GetCapacity() ? written - buffer->GetCapacity() : 0;
+
+		std::fprintf(file, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"%s\"}}", tid, buffer->GetThreadName().c_str());
+
+		for (std::uint64_t i = first; i < written; ++i)
+		{
+			const TraceEvent& event = buffer->GetEvent(i);
+
+			// Zones still open when tracing started have no meaningful start; drop them.
+			if (event.begin < start_)
+			{
+				continue;
+			}
+
+			std::fprintf(file, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}", 
+				event.name, tid, (event.begin - start_) * us_per_tick, (event.end - event.begin) * us_per_tick);
+		}
+
+		total += written - first;
+		dropped += first;
+	}
+
+	std::fputs("\n]}\n", file);
+	std::fclose(file);
+
+	printf("Wrote %llu trace events to %s", static_cast<unsigned long long>(total), path_.c_str());
+
+	if (dropped > 0)
+	{
+		printf(" (%llu older events overwritten)", static_cast<unsigned long long>(dropped));
+	}
+
+	printf("\n");
+
+	return true;
+}
+
+void Trace::SetThreadName(const char* name)
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	GetThreadBuffer()->SetThreadName(name);
+}
+
+TraceSession::TraceSession(const char* path) : 
+	active_(path != nullptr)
+{
+	if (active_)
+	{
+		Trace::Start(path);
+		Trace::SetThreadName("main");
+	}
+}
+
+TraceSession::~TraceSession()
+{
+	if (active_)
+	{
+		Trace::Stop();
+	}
+}
@@ -0,0 +1,89 @@
+#include "TranspositionTable.hpp"
+
+#include <cstring>
+
+namespace
+{
+	static_assert(sizeof(TranspositionEntry) == sizeof(std::uint64_t), "TranspositionEntry must pack into one word");
+
+	std::uint64_t Pack(const TranspositionEntry& entry)
+	{
+		std::uint64_t data = 0;
+		std::memcpy(&data, &entry, sizeof(data));
+
+		return data;
+	}
+
+	TranspositionEntry Unpack(std::uint64_t data)
+	{
+		TranspositionEntry entry;
+		std::memcpy(&entry, &data, sizeof(entry));
+
+		return entry;
+	}
+}
+
+TranspositionTable::TranspositionTable(std::size_t entry_count) : 
+	mask_(0)
+{
+	std::size_t size = 1;
+
+	while (size < entry_count)
+	{
+		size <<= 1;
+	}
+
+	slots_ = std::make_unique<Slot[]>(size);
+	mask_ = size - 1;
+
+	Clear();
+}
+
+TranspositionTable::~TranspositionTable()
+{
+}
+
+void TranspositionTable::Clear()
+{
+	for (std::size_t i = 0; i <= mask_; ++i)
+	{
+		slots_[i].check_.store(0, std::memory_order_relaxed);
+		slots_[i].data_.store(0, std::memory_order_relaxed);
+	}
+}
+
+void TranspositionTable::Store(std::uint64_t hash, const TranspositionEntry& entry)
+{
+	Slot& slot = slots_[hash & mask_];
+	const std::uint64_t data = slot.data_.load(std::memory_order_relaxed);
+
+	if ((slot.check_.load(std::memory_order_relaxed) ^ data) == hash && Unpack(data).bound != Bound::NONE && Unpack(data).depth > entry.depth)
+	{
+		return;
+	}
+
+	const std::uint64_t packed = Pack(entry);
+
+	slot.check_.store(hash ^ packed, std::memory_order_relaxed);
+	slot.data_.store(packed, std::memory_order_relaxed);
+}
+
+bool TranspositionTable::Probe(std::uint64_t hash, TranspositionEntry& entry) const
+{
+	const Slot& slot = slots_[hash & mask_];
+	const std::uint64_t data = slot.data_.load(std::memory_order_relaxed);
+
+	if ((slot.check_.load(std::memory_order_relaxed) ^ data) != hash)
+	{
+		return false;
+	}
+
+	entry = Unpack(data);
+
+	return entry.bound != Bound::NONE;
+}
+
+std::size_t TranspositionTable::GetSize() const
+{
+	return mask_ + 1;
+}
@@ -0,0 +1,236 @@
+#include "VecEnv.hpp"
+#include "VecEnv.h"
+#include "Game.hpp"
+#include "Constants.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	// The eight bytes, 0 or 1, that each possible bitset byte expands to.
+	const std::array<std::array<std::uint8_t, 8>, 256> bit_bytes = []()
+	{
+		std::array<std::array<std::uint8_t, 8>, 256> table{};
+
+		for (int value = 0; value < 256; ++value)
+		{
+			for (int bit = 0; bit < 8; ++bit)
+			{
+				table[value][bit] = static_cast<std::uint8_t>((value >> bit) & 1);
+			}
+		}
+
+		return table;
+	}();
+
+	void ExpandBits(const std::uint64_t* words, std::uint8_t* bytes, std::size_t count)
+	{
+		std::size_t i = 0;
+
+		for (; i + 8 <= count; i += 8)
+		{
+			std::memcpy(bytes + i, bit_bytes[static_cast<std::uint8_t>(words[i / 64] >> (i % 64))].data(), 8);
+		}
+
+		for (; i < count; ++i)
+		{
+			bytes[i] = static_cast<std::uint8_t>((words[i / 64] >> (i % 64)) & 1);
+		}
+	}
+}
+
+VecEnv::VecEnv(int env_count, int thread_count) : 
+	states_(static_cast<std::size_t>(std::max(env_count, 0))), 
+	initial_{}, 
+	pool_(thread_count), 
+	width_(0), 
+	height_(0), 
+	ghost_count_(0)
+{
+}
+
+VecEnv::~VecEnv()
+{
+}
+
+bool VecEnv::Initialize(const char* level_path)
+{
+	games_.clear();
+
+	for (int i = 0; i < pool_.GetThreadCount(); ++i)
+	{
+		games_.push_back(std::make_unique<Game>(true));
+
+		if (level_path != nullptr && !games_.back()->LoadLevel(level_path))
+		{
+			return false;
+		}
+	}
+
+	if (!games_[0]->Snapshot(initial_))
+	{
+		printf("Environments need a level of at most %d tiles and at most %d ghosts!\n", GameState::max_tiles, GameState::max_ghosts);
+		return false;
+	}
+
+	Level* level = games_[0]->GetLevel();
+
+	width_ = level->GetPixelWidth();
+	height_ = level->GetPixelHeight();
+	ghost_count_ = initial_.ghost_count;
+	walls_.resize(static_cast<std::size_t>(width_) * height_);
+
+	for (int i = 0; i < level->GetTileCount(); ++i)
+	{
+		walls_[i] = level->IsWall(i) ? 1 : 0;
+	}
+
+	return true;
+}
+
+void VecEnv::Reset(std::uint8_t* observations)
+{
+	for (std::size_t i = 0; i < states_.size(); ++i)
+	{
+		states_[i] = initial_;
+		WriteObservation(states_[i], observations + i * GetObservationSize());
+	}
+}
+
+void VecEnv::Step(const std::uint8_t* actions, std::uint8_t* observations, float* rewards, std::uint8_t* dones)
+{
+	TRACE_ZONE("VecEnv::Step");
+
+	for (int shard = 0; shard < static_cast<int>(games_.size()); ++shard)
+	{
+		pool_.Submit([this, shard, actions, observations, rewards, dones]()
+		{
+			StepShard(shard, actions, observations, rewards, dones);
+		});
+	}
+
+	pool_.Wait();
+}
+
+void VecEnv::StepShard(int shard, const std::uint8_t* actions, std::uint8_t* observations, float* rewards, std::uint8_t* dones)
+{
+	Game* game = games_[shard].get();
+	const std::size_t first = states_.size() * shard / games_.size();
+	const std::size_t last = states_.size() * (shard + 1) / games_.size();
+
+	for (std::size_t i = first; i < last; ++i)
+	{
+		GameState& state = states_[i];
+		const int score = state.score;
+		const Direction action = actions[i] < static_cast<std::uint8_t>(Direction::NONE) ? static_cast<Direction>(actions[i]) : Direction::NONE;
+
+		game->Step(state, action);
+
+		rewards[i] = static_cast<float>(state.score - score);
+		dones[i] = state.game_over || state.level_completed;
+
+		if (dones[i])
+		{
+			game->Restore(state);
+			game->Reset();
+			game->Snapshot(state);
+		}
+
+		WriteObservation(state, observations + i * GetObservationSize());
+	}
+}
+
+void VecEnv::WriteObservation(const GameState& state, std::uint8_t* observation) const
+{
+	const std::size_t plane = walls_.size();
+
+	std::memcpy(observation + plane * static_cast<int>(ObservationPlane::WALLS), walls_.data(), plane);
+	ExpandBits(state.pellets, observation + plane * static_cast<int>(ObservationPlane::PELLETS), plane);
+	ExpandBits(state.energizers, observation + plane * static_cast<int>(ObservationPlane::ENERGIZERS), plane);
+
+	std::uint8_t* entities = observation + plane * static_cast<int>(ObservationPlane::PLAYER);
+	std::memset(entities, 0, plane * (1 + ghost_count_));
+
+	entities[state.player.tile] = 1;
+
+	for (int i = 0; i < ghost_count_; ++i)
+	{
+		entities[plane * (1 + i) + state.ghosts[i].tile] = 1;
+	}
+}
+
+int VecEnv::GetEnvCount() const
+{
+	return static_cast<int>(states_.size());
+}
+
+int VecEnv::GetPlaneCount() const
+{
+	return static_cast<int>(ObservationPlane::GHOSTS) + ghost_count_;
+}
+
+int VecEnv::GetWidth() const
+{
+	return width_;
+}
+
+int VecEnv::GetHeight() const
+{
+	return height_;
+}
+
+std::size_t VecEnv::GetObservationSize() const
+{
+	return static_cast<std::size_t>(GetPlaneCount()) * walls_.size();
+}
+
+VecEnvHandle* vec_env_create(int env_count, int thread_count, const char* level_path)
+{
+	VecEnv* env = new VecEnv(env_count, thread_count);
+
+	if (!env->Initialize(level_path))
+	{
+		delete env;
+		return nullptr;
+	}
+
+	return reinterpret_cast<VecEnvHandle*>(env);
+}
+
+void vec_env_destroy(VecEnvHandle* env)
+{
+	delete reinterpret_cast<VecEnv*>(env);
+}
+
+int vec_env_count(const VecEnvHandle* env)
+{
+	return reinterpret_cast<const VecEnv*>(env)->GetEnvCount();
+}
+
+int vec_env_observation_size(const VecEnvHandle* env)
+{
+	return static_cast<int>(reinterpret_cast<const VecEnv*>(env)->GetObservationSize());
+}
+
+void vec_env_observation_shape(const VecEnvHandle* env, int* plane_count, int* height, int* width)
+{
+	const VecEnv* vec_env = reinterpret_cast<const VecEnv*>(env);
+
+	*plane_count = vec_env->GetPlaneCount();
+	*height = vec_env->GetHeight();
+	*width = vec_env->GetWidth();
+}
+
+void vec_env_reset(VecEnvHandle* env, uint8_t* observations)
+{
+	reinterpret_cast<VecEnv*>(env)->Reset(observations);
+}
+
+void vec_env_step(VecEnvHandle* env, const uint8_t* actions, uint8_t* observations, float* rewards, uint8_t* dones)
+{
+	reinterpret_cast<VecEnv*>(env)->Step(actions, observations, rewards, dones);
+}
@@ -1,14 +1,292 @@
 #include "Game.hpp"
+#include "BatchRunner.hpp"
+#include "Constants.hpp"
+#include "Trace.hpp"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 int main(int argc, char* argv[])
 {
-	(void) argc;
-	(void) argv;
+	bool headless = false;
+	int ticks = -1;
+	int batch = 0;
+	int threads = static_cast<int>(std::thread::hardware_concurrency());
+	std::uint32_t seed = 1;
+	double speed = 1.0;
+	double fps = -1.0;
+	const char* record_path = nullptr;
+	const char* metrics_path = nullptr;
+	const char* trace_path = nullptr;
+	const char* replay_path = nullptr;
+	const char* corpus_path = nullptr;
+	const char* level_path = nullptr;
+	int ghosts = constants::default_ghost_count;
+	int rewind_seconds = 0;
 
-	const std::unique_ptr<Game> game = std::make_unique<Game>();
-	game->Run();
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--headless") == 0)
+		{
+			headless = true;
+		}
+		else if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+		{
+			ticks = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc)
+		{
+			batch = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+		{
+			threads = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--speed") == 0 && i + 1 < argc)
+		{
+			speed = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+		{
+			seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+		{
+			fps = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--metrics") == 0 && i + 1 < argc)
+		{
+			metrics_path = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+		{
+			trace_path = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+		{
+			record_path = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+		{
+			replay_path = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--ghosts") == 0 && i + 1 < argc && std::atoi(argv[i + 1]) > 0 && std::atoi(argv[i + 1]) <= constants::max_ghost_count)
+		{
+			ghosts = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--rewind") == 0 && i + 1 < argc && std::atoi(argv[i + 1]) > 0)
+		{
+			rewind_seconds = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+		{
+			level_path = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--replay-corpus") == 0 && i + 1 < argc)
+		{
+			corpus_path = argv[++i];
+		}
+		else
+		{
+			printf("Usage: %s [--level FILE] [--ghosts N] [--speed X] [--fps N] [--metrics FILE] [--trace FILE] [--record FILE | --replay FILE | --rewind SECONDS] [--headless [--ticks N]] [--batch GAMES [--threads N] [--ticks N] [--seed S]] [--replay-corpus DIR [--threads N]]\n", argv[0]);
+			printf("  --level FILE  play on a level image or compiled .lvl of any size instead of the default maze\n");
+			printf("  --ghosts N  play against N ghosts; past the classic four they are a swarm chasing along one shared flow field\n");
+			printf("  --speed X  simulation speed multiplier for the windowed game, 0 runs unbounded\n");
+			printf("  --fps N  cap the windowed game at N frames per second instead of vsync, 0 leaves it uncapped\n");
+			printf("  --metrics FILE  write per-phase p50/p99/max timings every second, as JSON if FILE ends in .json, CSV otherwise\n");
+			printf("  --trace FILE  write a Chrome trace (chrome://tracing, Perfetto) of the run's profiling zones\n");
+			printf("  --record FILE  save the windowed session's input to FILE on exit\n");
+			printf("  --replay FILE  play back a recorded session, windowed or headless\n");
+			printf("  --rewind SECONDS  keep the last SECONDS of play; Backspace steps the windowed game back one second\n");
+			printf("  --replay-corpus DIR  replay every .rpl file in DIR through the batch runner\n");
+			return 1;
+		}
+	}
+
+	if (rewind_seconds > 0 && (record_path != nullptr || replay_path != nullptr))
+	{
+		printf("--rewind cannot be combined with --record or --replay; rewinding would break the recording.\n");
+		return 1;
+	}
+
+	const TraceSession trace_session(trace_path);
+
+	// Batch jobs each load the level for themselves; check it once so a bad path stops the run
+	// instead of turning every game into an empty result.
+	if (level_path != nullptr && (corpus_path != nullptr || batch > 0) && !Game(true).LoadLevel(level_path))
+	{
+		return 1;
+	}
+
+	if (corpus_path != nullptr)
+	{
+		std::vector<std::string> paths;
+		std::error_code error;
+
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(corpus_path, error))
+		{
+			if (entry.is_regular_file() && entry.path().extension() == ".rpl")
+			{
+				paths.push_back(entry.path().string());
+			}
+		}
+
+		if (error)
+		{
+			printf("Unable to read replay corpus %s! Error: %s\n", corpus_path, error.message().c_str());
+			return 1;
+		}
+
+		std::sort(paths.begin(), paths.end());
+
+		std::vector<BatchJob> jobs;
+		jobs.reserve(paths.size());
+
+		for (std::size_t i = 0; i < paths.size(); ++i)
+		{
+			jobs.push_back({ 0, 0, {}, paths[i], level_path != nullptr ? level_path : "", ghosts });
+		}
+
+		BatchRunner runner(threads);
+		const std::vector<BatchResult> results = runner.Run(jobs);
+
+		int failed = 0;
+
+		for (const BatchResult& result : results)
+		{
+			if (!result.loaded)
+			{
+				printf("%s: could not be loaded\n", paths[result.job].c_str());
+				++failed;
+				continue;
+			}
+
+			if (!result.hash_matches)
+			{
+				printf("%s: state hash desync\n", paths[result.job].c_str());
+				++failed;
+			}
+
+			printf("%s: Score: %d, Lives: %d, Levels Cleared: %d, Ticks: %d\n", paths[result.job].c_str(), result.score, result.lives, result.levels_cleared, result.game_ticks);
+		}
+
+		runner.PrintReport();
+
+		return failed == 0 ? 0 : 1;
+	}
+
+	if (batch > 0)
+	{
+		const int game_ticks = ticks < 0 ? 60 * 60 * 10 : ticks;
+
+		std::vector<BatchJob> jobs;
+		jobs.reserve(batch);
+
+		for (int i = 0; i < batch; ++i)
+		{
+			const std::uint32_t job_seed = seed + static_cast<std::uint32_t>(i);
+			jobs.push_back({ job_seed, game_ticks, BatchRunner::MakeRandomScript(job_seed, game_ticks), {}, level_path != nullptr ? level_path : "", ghosts });
+		}
+
+		BatchRunner runner(threads);
+		const std::vector<BatchResult> results = runner.Run(jobs);
+		runner.PrintReport();
+
+		const long failed = std::count_if(results.begin(), results.end(), [](const BatchResult& result)
+		{
+			return !result.loaded;
+		});
+
+		const long desynced = std::count_if(results.begin(), results.end(), [](const BatchResult& result)
+		{
+			return !result.hash_matches;
+		});
+
+		if (failed > 0)
+		{
+			printf("%ld of %d games could not be loaded\n", failed, batch);
+		}
+
+		if (desynced > 0)
+		{
+			printf("%ld of %d games ended with a state hash desync\n", desynced, batch);
+		}
+
+		return failed == 0 && desynced == 0 ? 0 : 1;
+	}
+
+	const std::unique_ptr<Game> game = std::make_unique<Game>(headless);
+
+	// Replays check the level hash, so the level has to be in place before one is loaded.
+	if (level_path != nullptr && !game->LoadLevel(level_path))
+	{
+		return 1;
+	}
+
+	game->SetGhostCount(ghosts);
+
+	if (metrics_path != nullptr && !game->GetMetrics()->Open(metrics_path))
+	{
+		return 1;
+	}
+
+	if (replay_path != nullptr && !game->LoadReplay(replay_path))
+	{
+		return 1;
+	}
+
+	if (rewind_seconds > 0 && !game->StartRewind(rewind_seconds))
+	{
+		return 1;
+	}
+
+	if (headless)
+	{
+		if (replay_path != nullptr)
+		{
+			game->RunHeadless(ticks < 0 ? game->GetReplayLength() : ticks, {}, false);
+		}
+		else
+		{
+			game->RunHeadless(ticks < 0 ? 1000000 : ticks);
+		}
+	}
+	else
+	{
+		if (record_path != nullptr)
+		{
+			game->StartRecording();
+		}
+
+		if (fps > 0.0)
+		{
+			game->SetFrameMode(FrameMode::CAPPED, fps);
+		}
+		else if (fps == 0.0)
+		{
+			game->SetFrameMode(FrameMode::UNCAPPED);
+		}
+
+		game->SetSpeed(speed);
+		game->Run();
+
+		if (game->GetRewind() != nullptr)
+		{
+			printf("Rewind buffer: %zu bytes for %d seconds of play\n", game->GetRewind()->GetMemoryUsage(), rewind_seconds);
+		}
+
+		if (record_path != nullptr && !game->SaveRecording(record_path))
+		{
+			return 1;
+		}
+	}
 
 	return 0;
 }
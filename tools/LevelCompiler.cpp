@@ -0,0 +1,58 @@
+#include "Game.hpp"
+#include "Level.hpp"
+#include "MazeGenerator.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Compiles a level image into the .lvl format Level memory-maps at startup, or generates a random
+// maze of any size straight into one.
+int main(int argc, char* argv[])
+{
+	const bool generate = argc == 6 && std::strcmp(argv[1], "--generate") == 0;
+
+	if (argc != 3 && !generate)
+	{
+		printf("Usage: %s LEVEL.png LEVEL.lvl\n", argv[0]);
+		printf("       %s --generate WIDTH HEIGHT SEED LEVEL.lvl\n", argv[0]);
+		return 1;
+	}
+
+	Game game(true);
+	Level level(&game);
+
+	if (generate)
+	{
+		const int width = std::atoi(argv[2]);
+		const int height = std::atoi(argv[3]);
+		SDL_Surface* surface = GenerateMaze(width, height, static_cast<std::uint32_t>(std::strtoul(argv[4], nullptr, 10)));
+
+		if (surface == nullptr)
+		{
+			printf("Unable to generate a %dx%d maze!\n", width, height);
+			return 1;
+		}
+
+		const bool initialized = level.Initialize(surface);
+		SDL_FreeSurface(surface);
+
+		if (!initialized || !level.Save(argv[5]))
+		{
+			return 1;
+		}
+
+		printf("Generated %dx%d maze %s\n", width, height, argv[5]);
+
+		return 0;
+	}
+
+	if (!level.Initialize(argv[1]) || !level.Save(argv[2]))
+	{
+		return 1;
+	}
+
+	printf("Compiled %s (%dx%d) to %s\n", argv[1], level.GetPixelWidth(), level.GetPixelHeight(), argv[2]);
+
+	return 0;
+}